@@ -1,32 +1,47 @@
 #include "AnasenArray.h"
 #include "PCDetector.h"
+#include "Sim/SimBase.h"
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 namespace AnasenSim {
 
-	AnasenArray::AnasenArray(const Target& gas) :
-		m_detectorEloss({14}, {28}, {1}, s_detectorDensity), m_gasEloss(gas), m_nullPoint(0., 0., 0.)
+	AnasenArray::AnasenArray(const Target& gas, const AnasenGeometry& geometry) :
+		m_detectorEloss({14}, {28}, {1}, s_detectorDensity), m_gasEloss(gas), m_nullPoint(0., 0., 0.),
+		m_barrelRhoMin(geometry.barrelRhoList[0]), m_geometry(geometry), m_qqqZMin(geometry.qqqZList[0])
 	{
 		for(int i=0; i<s_nSX3PerBarrel; i++)
 		{
-			m_barrel1.emplace_back(s_barrelPhiList[i], s_barrel1Z, s_barrelRhoList[i]);
-			m_barrel1[i].SetPixelSmearing(true);
-			m_barrel2.emplace_back(s_barrelPhiList[i], s_barrel2Z, s_barrelRhoList[i]);
-			m_barrel2[i].SetPixelSmearing(true);
+			m_barrelRhoMin = std::min(m_barrelRhoMin, m_geometry.barrelRhoList[i]);
+			m_barrel1.emplace_back(m_geometry.barrelPhiList[i], m_geometry.barrel1Z, m_geometry.barrelRhoList[i]);
+			m_barrel2.emplace_back(m_geometry.barrelPhiList[i], m_geometry.barrel2Z, m_geometry.barrelRhoList[i]);
 		}
 		for(int i=0; i<s_nQQQ; i++)
 		{
-			m_qqq.emplace_back(s_qqqPhiList[i], s_qqqZList[i]);
-			m_qqq[i].SetSmearing(true);
+			m_qqqZMin = std::min(m_qqqZMin, m_geometry.qqqZList[i]);
+			m_qqq.emplace_back(m_geometry.qqqPhiList[i], m_geometry.qqqZList[i]);
 		}
+		m_planes = PlaneTable(m_barrel1, m_barrel2, m_qqq);
 	}
 
 	AnasenArray::~AnasenArray() {}
 
+	void AnasenArray::InitEnergyLossTables(const std::vector<NucleusRecord>& nuclei, const TableCache* cache)
+	{
+		for(const NucleusRecord& nucleus : nuclei)
+		{
+			if(nucleus.role == Nucleus::ReactionRole::Target || nucleus.role == Nucleus::ReactionRole::Projectile)
+				continue;
+			m_gasEloss.InitRangeTable(nucleus.Z, nucleus.A, cache);
+			m_detectorEloss.InitRangeTable(nucleus.Z, nucleus.A, cache);
+		}
+	}
+
 
-	void AnasenArray::DrawDetectorSystem(const std::string& filename)
+	void AnasenArray::DrawDetectorSystem(const std::string& filename) const
 	{
 		std::ofstream output(filename);
 		output<<"ANASEN Geometry File -- Coordinates for Detectors"<<std::endl;
@@ -120,7 +135,7 @@ namespace AnasenSim {
 		output.close();
 	}
 
-	double AnasenArray::RunConsistencyCheck()
+	double AnasenArray::RunConsistencyCheck() const
 	{
 		std::vector<ROOT::Math::XYZPoint> r1_points;
 		std::vector<ROOT::Math::XYZPoint> r2_points;
@@ -128,19 +143,16 @@ namespace AnasenSim {
 		std::vector<ROOT::Math::XYZPoint> bqqq_points;
 		for(int i=0; i<s_nSX3PerBarrel; i++)
 		{
-			m_barrel1[i].SetPixelSmearing(false);
 			for(int j=0; j<4; j++)
 				r1_points.push_back(m_barrel1[i].GetHitCoordinates(j, -1.0));
 		}
 		for(int i=0; i<s_nSX3PerBarrel; i++)
 		{
-			m_barrel2[i].SetPixelSmearing(false);
 			for(int j=0; j<4; j++)
 				r2_points.push_back(m_barrel2[i].GetHitCoordinates(j, -1.0));
 		}
 		for(int i=0; i<s_nQQQ; i++)
 		{
-			m_qqq[i].SetSmearing(false);
 			for(int j=0; j<16; j++)
 			{
 				for(int k=0; k<16; k++)
@@ -200,43 +212,128 @@ namespace AnasenSim {
 
 	}
 
-	void AnasenArray::IsBarrel1(Nucleus& nucleus)
+	/*
+		Cheap pre-check using the tabulated gas range. The distance to the nearest silicon is bounded from below
+		without any detector lookup: barrel hits lie at cylindrical radius >= m_barrelRhoMin (reached no faster than
+		sin(theta) per unit path), and QQQ hits lie at or beyond the plane z = m_qqqZMin. The smeared hit position can be at most
+		s_maxSmearDistance closer than the true intersection. If the particle cannot reach that distance with more than
+		the silicon threshold energy left, it can never be detected.
+	*/
+	bool AnasenArray::IsStoppedInGas(const NucleusRecord& nucleus) const
+	{
+		const RangeTable* table = m_gasEloss.GetRangeTable(nucleus.Z, nucleus.A);
+		if(table == nullptr)
+			return false;
+
+		double usableRange = (table->GetRange(nucleus.GetKE()) - table->GetRange(s_energyThreshold)) * (1.0 + s_rangeTolerance);
+
+		double theta = nucleus.GetVec4().Theta();
+		double sinTheta = std::sin(theta);
+		double cosTheta = std::cos(theta);
+		double rhoToBarrel = m_barrelRhoMin - nucleus.GetRxnPoint().Rho();
+		double nearestSi = std::numeric_limits<double>::max();
+		if(sinTheta > s_epsilon)
+			nearestSi = std::max(rhoToBarrel, rhoToBarrel / sinTheta - s_maxSmearDistance);
+		if(cosTheta > s_epsilon)
+			nearestSi = std::min(nearestSi, m_qqqZMin - nucleus.GetRxnPoint().Z());
+
+		return usableRange < nearestSi;
+	}
+
+	//Gas energy loss from the vertex to the PC and on to the silicon from a single transport. Sets pcDetE, returns energy at the silicon
+	double AnasenArray::TransportToSilicon(NucleusRecord& nucleus) const
+	{
+		double kineticEnergy = nucleus.GetKE();
+		double pathToSi = (nucleus.GetSiVector() - nucleus.GetRxnPoint()).R();
+		double energies[2];
+		if(Precision::IsFloatAlmostEqual(nucleus.pcZ, 0.0, s_epsilon))
+		{
+			nucleus.pcDetE = -1.0;
+			m_gasEloss.GetEnergiesAlongPath(nucleus.Z, nucleus.A, kineticEnergy, &pathToSi, energies, 1);
+			return energies[0];
+		}
+
+		double pathToPC = (nucleus.GetPCVector() - nucleus.GetRxnPoint()).R();
+		//PC z is smeared, so in rare cases the PC "crossing" lies beyond the silicon
+		if(pathToPC <= pathToSi)
+		{
+			double paths[2] = {pathToPC, pathToSi};
+			m_gasEloss.GetEnergiesAlongPath(nucleus.Z, nucleus.A, kineticEnergy, paths, energies, 2);
+			nucleus.pcDetE = kineticEnergy - energies[0];
+			return energies[1];
+		}
+		else
+		{
+			double paths[2] = {pathToSi, pathToPC};
+			m_gasEloss.GetEnergiesAlongPath(nucleus.Z, nucleus.A, kineticEnergy, paths, energies, 2);
+			nucleus.pcDetE = kineticEnergy - energies[1];
+			return energies[0];
+		}
+	}
+
+	/*
+		Silicon response for a fixed-thickness detector crossed at thetaIncident. With a silicon range table the deposit follows
+		from the residual range after the effective thickness, which is exact in angle and needs no catima integration.
+	*/
+	SiliconResponse AnasenArray::GetSiliconResponse(const NucleusRecord& nucleus, double energyAtSi, double thetaIncident) const
+	{
+		SiliconResponse response;
+		double effectiveThickness = s_detectorThickness / std::fabs(std::cos(thetaIncident));
+		const RangeTable* table = m_detectorEloss.GetRangeTable(nucleus.Z, nucleus.A);
+		if(table == nullptr)
+		{
+			response.depositedEnergy = m_detectorEloss.GetEnergyLoss(nucleus.Z, nucleus.A, energyAtSi, effectiveThickness);
+			response.isPunchThrough = response.depositedEnergy < energyAtSi;
+			return response;
+		}
+
+		double residualRange = table->GetRange(energyAtSi) - effectiveThickness;
+		if(residualRange <= 0.0)
+		{
+			response.depositedEnergy = energyAtSi;
+			response.isPunchThrough = false;
+		}
+		else
+		{
+			response.depositedEnergy = energyAtSi - table->GetEnergy(residualRange);
+			response.isPunchThrough = true;
+		}
+		return response;
+	}
+
+	void AnasenArray::IsBarrel1(NucleusRecord& nucleus, const PCHit& pcResult, const DeadChannelMap& deadMap, DetectorHits& hits, DetectorContext& context) const
 	{
-		static double thetaIncident;
-		static double effectiveThickness;
-		static double energyAtSi;
+		double thetaIncident;
+		double energyAtSi;
+		SX3Hit results[s_nSX3PerBarrel];
+		m_planes.IntersectSX3(PlaneTable::Barrel1, nucleus.GetRxnPoint(), nucleus.GetVec4().Theta(), nucleus.GetVec4().Phi(), results);
 		for(int i=0; i<s_nSX3PerBarrel; i++)
 		{
-			auto result = m_barrel1[i].GetChannelRatio(nucleus.rxnPoint, nucleus.vec4.Theta(), nucleus.vec4.Phi());
+			const SX3Hit& result = results[i];
 			if(result.front_strip_index != -1 && 
-			   !m_deadMap.IsChannelPairDead(i, result.front_strip_index, result.back_strip_index, DeadChannelMap::DetectorType::Barrel1)) 
+			   !deadMap.IsChannelPairDead(i, result.front_strip_index, result.back_strip_index, DeadChannelMap::DetectorType::Barrel1)) 
 			{
 				nucleus.isDetected = true;
-				auto pcResult = PCDetector::AssignPC(nucleus.rxnPoint, nucleus.vec4.Theta(), nucleus.vec4.Phi(), nucleus.Z);
-				if(pcResult.wireID == -1 || m_deadMap.IsWireDead(pcResult.wireID))
+				hits.Add(DeadChannelMap::DetectorType::Barrel1, i, result.front_strip_index, result.back_strip_index, pcResult.wireID);
+				if(pcResult.wireID == -1 || deadMap.IsWireDead(pcResult.wireID))
 				{
 					nucleus.isDetected = false;
-					nucleus.siVector.SetXYZ(0., 0., 0.);
+					nucleus.SetSiVector(m_nullPoint);
 					nucleus.siliconDetKE = 0.0;
 					return;
 				}
-				nucleus.pcVector = pcResult.hit;
-				nucleus.siVector = m_barrel1[i].GetHitCoordinates(result.front_strip_index, result.front_ratio);
+				nucleus.SetPCVector(pcResult.hit);
+				nucleus.SetSiVector(m_barrel1[i].GetHitCoordinates(result.front_strip_index, result.front_ratio, context.GetUniformFraction()));
 
-				thetaIncident = std::acos(nucleus.siVector.Dot(m_barrel1[i].GetNormRotated())/nucleus.siVector.R());
-				effectiveThickness = s_detectorThickness/std::fabs(std::cos(thetaIncident));
-				if(!Precision::IsFloatAlmostEqual(nucleus.pcVector.Z(), 0.0, s_epsilon))
-					nucleus.pcDetE = m_gasEloss.GetEnergyLoss(nucleus.Z, nucleus.A, nucleus.GetKE(), (nucleus.pcVector - nucleus.rxnPoint).R());
-				else
-					nucleus.pcDetE = -1.0;
-				energyAtSi = nucleus.GetKE() - m_gasEloss.GetEnergyLoss(nucleus.Z, nucleus.A, nucleus.GetKE(), (nucleus.siVector - nucleus.rxnPoint).R());
+				thetaIncident = std::acos(nucleus.GetSiVector().Dot(m_barrel1[i].GetNormRotated())/nucleus.GetSiVector().R());
+				energyAtSi = TransportToSilicon(nucleus);
 				if(!Precision::IsFloatAlmostEqual(thetaIncident, M_PI/2.0, s_epsilon))
 				{
-					nucleus.siliconDetKE = m_detectorEloss.GetEnergyLoss(nucleus.Z, nucleus.A, energyAtSi, effectiveThickness);
+					nucleus.siliconDetKE = GetSiliconResponse(nucleus, energyAtSi, thetaIncident).depositedEnergy;
 					if(Precision::IsFloatLessOrAlmostEqual(nucleus.siliconDetKE, s_energyThreshold, s_epsilon))
 					{
 						nucleus.isDetected = false;
-						nucleus.siVector.SetXYZ(0., 0., 0.);
+						nucleus.SetSiVector(m_nullPoint);
 						nucleus.siliconDetKE = 0.0;
 						return;
 					}
@@ -244,97 +341,92 @@ namespace AnasenSim {
 				else
 					nucleus.siliconDetKE = energyAtSi;
 
-				nucleus.siDetectorName = "R1";
+				nucleus.siDetector = SiliconDetector::Barrel1;
 				return;
 			}
 		}
 	}
 
-	void AnasenArray::IsBarrel2(Nucleus& nucleus)
+	void AnasenArray::IsBarrel2(NucleusRecord& nucleus, const PCHit& pcResult, const DeadChannelMap& deadMap, DetectorHits& hits, DetectorContext& context) const
 	{
-		static double thetaIncident;
-		static double effectiveThickness;
-		static double energyAtSi;
+		double thetaIncident;
+		double energyAtSi;
+		SX3Hit results[s_nSX3PerBarrel];
+		m_planes.IntersectSX3(PlaneTable::Barrel2, nucleus.GetRxnPoint(), nucleus.GetVec4().Theta(), nucleus.GetVec4().Phi(), results);
 		for(int i=0; i<s_nSX3PerBarrel; i++)
 		{
-			auto result = m_barrel2[i].GetChannelRatio(nucleus.rxnPoint, nucleus.vec4.Theta(), nucleus.vec4.Phi());
+			const SX3Hit& result = results[i];
 			if(result.front_strip_index != -1 && 
-			   !m_deadMap.IsChannelPairDead(i, result.front_strip_index, result.back_strip_index, DeadChannelMap::DetectorType::Barrel2))  
+			   !deadMap.IsChannelPairDead(i, result.front_strip_index, result.back_strip_index, DeadChannelMap::DetectorType::Barrel2))  
 			{
 				nucleus.isDetected = true;
-				auto pcResult = PCDetector::AssignPC(nucleus.rxnPoint, nucleus.vec4.Theta(), nucleus.vec4.Phi(), nucleus.Z);
-				if(pcResult.wireID == -1 || m_deadMap.IsWireDead(pcResult.wireID))
+				hits.Add(DeadChannelMap::DetectorType::Barrel2, i, result.front_strip_index, result.back_strip_index, pcResult.wireID);
+				if(pcResult.wireID == -1 || deadMap.IsWireDead(pcResult.wireID))
 				{
 					nucleus.isDetected = false;
-					nucleus.siVector.SetXYZ(0., 0., 0.);
+					nucleus.SetSiVector(m_nullPoint);
 					nucleus.siliconDetKE = 0.0;
 					return;
 				}
-				nucleus.pcVector = pcResult.hit;
-				nucleus.siVector = m_barrel2[i].GetHitCoordinates(result.front_strip_index, result.front_ratio);
+				nucleus.SetPCVector(pcResult.hit);
+				nucleus.SetSiVector(m_barrel2[i].GetHitCoordinates(result.front_strip_index, result.front_ratio, context.GetUniformFraction()));
 
-				thetaIncident = std::acos(nucleus.siVector.Dot(m_barrel2[i].GetNormRotated())/nucleus.siVector.R());
-				effectiveThickness = s_detectorThickness/std::fabs(std::cos(thetaIncident));
-				if(!Precision::IsFloatAlmostEqual(nucleus.pcVector.Z(), 0.0, s_epsilon))
-					nucleus.pcDetE = m_gasEloss.GetEnergyLoss(nucleus.Z, nucleus.A, nucleus.GetKE(), (nucleus.pcVector - nucleus.rxnPoint).R());
-				else
-					nucleus.pcDetE = -1.0;
-				energyAtSi = nucleus.GetKE() - m_gasEloss.GetEnergyLoss(nucleus.Z, nucleus.A, nucleus.GetKE(), (nucleus.siVector - nucleus.rxnPoint).R());
+				thetaIncident = std::acos(nucleus.GetSiVector().Dot(m_barrel2[i].GetNormRotated())/nucleus.GetSiVector().R());
+				energyAtSi = TransportToSilicon(nucleus);
 				if(!Precision::IsFloatAlmostEqual(thetaIncident, M_PI/2.0, s_epsilon))
 				{
-					nucleus.siliconDetKE = m_detectorEloss.GetEnergyLoss(nucleus.Z, nucleus.A, energyAtSi, effectiveThickness);
+					nucleus.siliconDetKE = GetSiliconResponse(nucleus, energyAtSi, thetaIncident).depositedEnergy;
 					if(Precision::IsFloatLessOrAlmostEqual(nucleus.siliconDetKE, s_energyThreshold, s_epsilon))
 					{
 						nucleus.isDetected = false;
-						nucleus.siVector.SetXYZ(0., 0., 0.);
+						nucleus.SetSiVector(m_nullPoint);
 						nucleus.siliconDetKE = 0.0;
 						return;
 					}
 				}
 				else
 					nucleus.siliconDetKE = energyAtSi;
-				nucleus.siDetectorName = "R2";
+				nucleus.siDetector = SiliconDetector::Barrel2;
 				return;
 			}
 		}
 	}
 
-	void AnasenArray::IsQQQ(Nucleus& nucleus)
+	void AnasenArray::IsQQQ(NucleusRecord& nucleus, const PCHit& pcResult, const DeadChannelMap& deadMap, DetectorHits& hits, DetectorContext& context) const
 	{
 		double thetaIncident;
-		double effectiveThickness;
-		static double energyAtSi;
+		double energyAtSi;
+		std::pair<int, int> results[s_nQQQ];
+		m_planes.IntersectQQQ(nucleus.GetRxnPoint(), nucleus.GetVec4().Theta(), nucleus.GetVec4().Phi(), results);
 		for(int i=0; i<s_nQQQ; i++)
 		{
-			auto result = m_qqq[i].GetTrajectoryRingWedge(nucleus.rxnPoint, nucleus.vec4.Theta(), nucleus.vec4.Phi());
-			if(result.first != -1) 
+			const std::pair<int, int>& result = results[i];
+			if(result.first != -1 &&
+			   !deadMap.IsChannelPairDead(i, result.first, result.second, DeadChannelMap::DetectorType::QQQ)) 
 			{
 				nucleus.isDetected = true;
-				auto pcResult = PCDetector::AssignPC(nucleus.rxnPoint, nucleus.vec4.Theta(), nucleus.vec4.Phi(), nucleus.Z);
-				if(pcResult.wireID == -1 || m_deadMap.IsWireDead(pcResult.wireID))
+				hits.Add(DeadChannelMap::DetectorType::QQQ, i, result.first, result.second, pcResult.wireID);
+				if(pcResult.wireID == -1 || deadMap.IsWireDead(pcResult.wireID))
 				{
 					nucleus.isDetected = false;
-					nucleus.siVector.SetXYZ(0., 0., 0.);
+					nucleus.SetSiVector(m_nullPoint);
 					nucleus.siliconDetKE = 0.0;
 					return;
 				}
-				nucleus.pcVector = pcResult.hit;
-				nucleus.siVector = m_qqq[i].GetHitCoordinates(result.first, result.second);
+				nucleus.SetPCVector(pcResult.hit);
+				double ringFraction = context.GetUniformFraction();
+				double wedgeFraction = context.GetUniformFraction();
+				nucleus.SetSiVector(m_qqq[i].GetHitCoordinates(result.first, result.second, ringFraction, wedgeFraction));
 
-				thetaIncident = std::acos(nucleus.siVector.Dot(m_qqq[i].GetNorm())/nucleus.siVector.R());
-				effectiveThickness = s_detectorThickness / std::fabs(std::cos(thetaIncident));
-				if(!Precision::IsFloatAlmostEqual(nucleus.pcVector.Z(), 0.0, s_epsilon))
-					nucleus.pcDetE = m_gasEloss.GetEnergyLoss(nucleus.Z, nucleus.A, nucleus.GetKE(), (nucleus.pcVector - nucleus.rxnPoint).R());
-				else
-					nucleus.pcDetE = -1.0;
-				energyAtSi = nucleus.GetKE() - m_gasEloss.GetEnergyLoss(nucleus.Z, nucleus.A, nucleus.GetKE(), (nucleus.siVector - nucleus.rxnPoint).R());
+				thetaIncident = std::acos(nucleus.GetSiVector().Dot(m_qqq[i].GetNorm())/nucleus.GetSiVector().R());
+				energyAtSi = TransportToSilicon(nucleus);
 				if(!Precision::IsFloatAlmostEqual(thetaIncident, M_PI/2.0, s_epsilon))
 				{
-					nucleus.siliconDetKE = m_detectorEloss.GetEnergyLoss(nucleus.Z, nucleus.A, energyAtSi, effectiveThickness);
+					nucleus.siliconDetKE = GetSiliconResponse(nucleus, energyAtSi, thetaIncident).depositedEnergy;
 					if(Precision::IsFloatLessOrAlmostEqual(nucleus.siliconDetKE, s_energyThreshold, s_epsilon))
 					{
 						nucleus.isDetected = false;
-						nucleus.siVector.SetXYZ(0., 0., 0.);
+						nucleus.SetSiVector(m_nullPoint);
 						nucleus.siliconDetKE = 0.0;
 						return;
 					}
@@ -342,29 +434,172 @@ namespace AnasenSim {
 				else
 					nucleus.siliconDetKE = energyAtSi;
 
-				nucleus.siDetectorName = "FQQQ";
+				nucleus.siDetector = SiliconDetector::FQQQ;
 				return;
 			}
 		}
 	}
 
-	void AnasenArray::IsDetected(Nucleus& nucleus)
+	void AnasenArray::IsDetected(NucleusRecord& nucleus, DetectorContext& context) const
 	{
-		if(nucleus.role == Nucleus::ReactionRole::Target || nucleus.role == Nucleus::ReactionRole::Projectile)
+		if(!IsCandidate(nucleus))
 			return;
 
-		if(nucleus.GetKE() <= s_energyThreshold) //Below silicon detection threshold
-			return;
-		else if(nucleus.rxnPoint.Z() > s_totalLength) //reaction occurs outside the detector
-			return;
+		PCHit pcResult = PCDetector::AssignPC(nucleus.GetRxnPoint(), nucleus.GetVec4().Theta(), nucleus.GetVec4().Phi(), nucleus.Z, context.generator);
+		DetectorHits hits;
+		Detect(nucleus, pcResult, m_deadMap, hits, context);
+	}
+
+	uint64_t AnasenArray::IsDetected(NucleusRecord& nucleus, const std::vector<DeadChannelMap>& deadMaps, DetectorContext& context) const
+	{
+		if(!IsCandidate(nucleus))
+			return 0;
 
+		PCHit pcResult = PCDetector::AssignPC(nucleus.GetRxnPoint(), nucleus.GetVec4().Theta(), nucleus.GetVec4().Phi(), nucleus.Z, context.generator);
+		return GetDetectionMask(nucleus, pcResult, deadMaps, context);
+	}
+
+	void AnasenArray::IsDetected(std::vector<NucleusRecord>& event, DetectorContext& context) const
+	{
+		AssignPCHits(event, context);
+		DetectorHits hits;
+		for(std::size_t i=0; i<event.size(); i++)
+		{
+			if(!context.isCandidate[i])
+				continue;
+			hits.nHits = 0;
+			Detect(event[i], context.pcHits[i], m_deadMap, hits, context);
+		}
+	}
+
+	void AnasenArray::IsDetected(std::vector<NucleusRecord>& event, const std::vector<DeadChannelMap>& deadMaps, std::vector<uint64_t>& masks,
+								 DetectorContext& context) const
+	{
+		AssignPCHits(event, context);
+		masks.assign(event.size(), 0);
+		for(std::size_t i=0; i<event.size(); i++)
+		{
+			if(context.isCandidate[i])
+				masks[i] = GetDetectionMask(event[i], context.pcHits[i], deadMaps, context);
+		}
+	}
+
+	//Cuts which do not depend on the detector geometry
+	bool AnasenArray::IsCandidate(const NucleusRecord& nucleus) const
+	{
+		if(nucleus.role == Nucleus::ReactionRole::Target || nucleus.role == Nucleus::ReactionRole::Projectile)
+			return false;
+		else if(nucleus.GetKE() <= s_energyThreshold) //Below silicon detection threshold
+			return false;
+		else if(nucleus.GetRxnPoint().Z() > s_totalLength) //reaction occurs outside the detector
+			return false;
+		else if(IsStoppedInGas(nucleus)) //Stops in the gas before any silicon
+			return false;
+		return true;
+	}
+
+	//PC response for every candidate of the event from a single batched call
+	void AnasenArray::AssignPCHits(const std::vector<NucleusRecord>& event, DetectorContext& context) const
+	{
+		context.isCandidate.assign(event.size(), 0);
+		context.pcHits.assign(event.size(), PCHit());
+		context.pcRxnX.clear();
+		context.pcRxnY.clear();
+		context.pcRxnZ.clear();
+		context.pcDirX.clear();
+		context.pcDirY.clear();
+		context.pcDirZ.clear();
+		context.pcZ.clear();
+		context.pcBatchHits.clear();
+		for(std::size_t i=0; i<event.size(); i++)
+		{
+			const NucleusRecord& nucleus = event[i];
+			if(!IsCandidate(nucleus))
+				continue;
+			context.isCandidate[i] = 1;
+
+			double theta = nucleus.GetVec4().Theta();
+			double phi = nucleus.GetVec4().Phi();
+			context.pcRxnX.push_back(nucleus.GetRxnPoint().X());
+			context.pcRxnY.push_back(nucleus.GetRxnPoint().Y());
+			context.pcRxnZ.push_back(nucleus.GetRxnPoint().Z());
+			context.pcDirX.push_back(std::sin(theta)*std::cos(phi));
+			context.pcDirY.push_back(std::sin(theta)*std::sin(phi));
+			context.pcDirZ.push_back(std::cos(theta));
+			context.pcZ.push_back(nucleus.Z);
+		}
+
+		PCBatch batch;
+		batch.rxnX = context.pcRxnX.data();
+		batch.rxnY = context.pcRxnY.data();
+		batch.rxnZ = context.pcRxnZ.data();
+		batch.dirX = context.pcDirX.data();
+		batch.dirY = context.pcDirY.data();
+		batch.dirZ = context.pcDirZ.data();
+		batch.zp = context.pcZ.data();
+		batch.size = context.pcZ.size();
+		context.pcBatchHits.resize(batch.size);
+		PCDetector::AssignPC(batch, context.pcBatchHits.data(), context.generator);
+
+		std::size_t index = 0;
+		for(std::size_t i=0; i<event.size(); i++)
+		{
+			if(context.isCandidate[i])
+				context.pcHits[i] = context.pcBatchHits[index++];
+		}
+	}
+
+	/*
+		Fan-out over several dead channel maps. Geometry and energy loss are evaluated once with every channel alive, recording
+		the channels each detector layer tested. A map which has all of those channels alive gives the identical result, so only
+		maps that kill one of them need a full re-evaluation (rare, as dead channels are a small fraction of the array).
+		Bit k of the return is set if the nucleus is detected with deadMaps[k]; the nucleus keeps its all-channels-alive response.
+	*/
+	uint64_t AnasenArray::GetDetectionMask(NucleusRecord& nucleus, const PCHit& pcResult, const std::vector<DeadChannelMap>& deadMaps,
+											  DetectorContext& context) const
+	{
+		DetectorHits hits;
+		Detect(nucleus, pcResult, m_liveMap, hits, context);
+
+		uint64_t mask = 0;
+		for(std::size_t k=0; k<deadMaps.size(); k++)
+		{
+			bool isAffected = false;
+			for(int i=0; i<hits.nHits; i++)
+			{
+				const DetectorHit& hit = hits.hits[i];
+				if(deadMaps[k].IsChannelPairDead(hit.detectorID, hit.frontChannel, hit.backChannel, hit.detectorType) ||
+				   deadMaps[k].IsWireDead(hit.wireID))
+				{
+					isAffected = true;
+					break;
+				}
+			}
+
+			bool isDetected = nucleus.isDetected;
+			if(isAffected)
+			{
+				NucleusRecord copy = nucleus;
+				ResetNucleusDetection(copy);
+				DetectorHits scratch;
+				Detect(copy, pcResult, deadMaps[k], scratch, context);
+				isDetected = copy.isDetected;
+			}
+			if(isDetected)
+				mask |= (uint64_t(1) << k);
+		}
+		return mask;
+	}
+
+	//Silicon layers in order of precedence. The PC response is the same whichever layer is hit.
+	void AnasenArray::Detect(NucleusRecord& nucleus, const PCHit& pcResult, const DeadChannelMap& deadMap, DetectorHits& hits, DetectorContext& context) const
+	{
 		if(!nucleus.isDetected)
-			IsBarrel1(nucleus);
+			IsBarrel1(nucleus, pcResult, deadMap, hits, context);
 		if(!nucleus.isDetected)
-			IsBarrel2(nucleus);
+			IsBarrel2(nucleus, pcResult, deadMap, hits, context);
 		if(!nucleus.isDetected)
-			IsQQQ(nucleus);
-
+			IsQQQ(nucleus, pcResult, deadMap, hits, context);
 	}
 
-}
\ No newline at end of file
+}
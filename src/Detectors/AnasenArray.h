@@ -6,60 +6,110 @@
 #include "SX3Detector.h"
 #include "QQQDetector.h"
 #include "Sim/Target.h"
-#include "Dict/Nucleus.h"
+#include "Sim/NucleusRecord.h"
 #include "DeadChannelMap.h"
+#include "AnasenGeometry.h"
+#include "PlaneTable.h"
+#include "PCDetector.h"
+#include "DetectorContext.h"
 
 namespace AnasenSim {
 
+	struct SiliconResponse
+	{
+		double depositedEnergy = 0.0; //MeV
+		bool isPunchThrough = false;
+	};
+
+	//Channels tested by one detector layer
+	struct DetectorHit
+	{
+		DeadChannelMap::DetectorType detectorType = DeadChannelMap::DetectorType::None;
+		uint32_t detectorID = 0;
+		uint32_t frontChannel = 0; //ring for QQQ
+		uint32_t backChannel = 0; //wedge for QQQ
+		uint32_t wireID = 0;
+	};
+
+	//At most one hit per layer (barrel 1, barrel 2, QQQ)
+	struct DetectorHits
+	{
+		void Add(DeadChannelMap::DetectorType type, int detID, int front, int back, int wire)
+		{
+			hits[nHits++] = { type, uint32_t(detID), uint32_t(front), uint32_t(back), uint32_t(wire) };
+		}
+
+		DetectorHit hits[3];
+		int nHits = 0;
+	};
+
+	/*
+		Detection methods are const: all random draws and scratch space come from the DetectorContext, so one array
+		can be shared between threads as long as each thread passes its own context. Setup (dead channel map, energy
+		loss tables) must be finished before detection starts.
+	*/
 	class AnasenArray
 	{
 	public:
-		AnasenArray(const Target& gas);
+		AnasenArray(const Target& gas, const AnasenGeometry& geometry = AnasenGeometry());
 		~AnasenArray();
-		void IsDetected(Nucleus& nucleus);
-		void DrawDetectorSystem(const std::string& filename);
-		double RunConsistencyCheck();
+		void IsDetected(NucleusRecord& nucleus, DetectorContext& context) const;
+		//Returns a bitmask with bit k set if the nucleus is detected under deadMaps[k] (at most 64 maps)
+		uint64_t IsDetected(NucleusRecord& nucleus, const std::vector<DeadChannelMap>& deadMaps, DetectorContext& context) const;
+		//Whole event at once; the PC response of every nucleus is found in a single batch
+		void IsDetected(std::vector<NucleusRecord>& event, DetectorContext& context) const;
+		void IsDetected(std::vector<NucleusRecord>& event, const std::vector<DeadChannelMap>& deadMaps, std::vector<uint64_t>& masks,
+						DetectorContext& context) const;
+		void DrawDetectorSystem(const std::string& filename) const;
+		double RunConsistencyCheck() const;
 		void SetDeadChannelMap(const std::string& filename) { m_deadMap.ReadFile(filename); }
+		//Build gas and silicon energy loss tables for every species which can be detected
+		void InitEnergyLossTables(const std::vector<NucleusRecord>& nuclei, const TableCache* cache = nullptr);
+		const AnasenGeometry& GetGeometry() const { return m_geometry; }
+		//Gas density scan without rebuilding the energy loss tables. Not safe while events are being detected
+		void SetGasDensity(double density) { m_gasEloss.SetDensity(density); } //g/cm^3
 
 	private:
-		void IsBarrel1(Nucleus& nucleus);
-		void IsBarrel2(Nucleus& nucleus);
-		void IsQQQ(Nucleus& nucleus);
+		bool IsStoppedInGas(const NucleusRecord& nucleus) const;
+		double TransportToSilicon(NucleusRecord& nucleus) const;
+		SiliconResponse GetSiliconResponse(const NucleusRecord& nucleus, double energyAtSi, double thetaIncident) const;
+		bool IsCandidate(const NucleusRecord& nucleus) const;
+		void AssignPCHits(const std::vector<NucleusRecord>& event, DetectorContext& context) const;
+		uint64_t GetDetectionMask(NucleusRecord& nucleus, const PCHit& pcResult, const std::vector<DeadChannelMap>& deadMaps,
+								  DetectorContext& context) const;
+		void Detect(NucleusRecord& nucleus, const PCHit& pcResult, const DeadChannelMap& deadMap, DetectorHits& hits, DetectorContext& context) const;
+		void IsBarrel1(NucleusRecord& nucleus, const PCHit& pcResult, const DeadChannelMap& deadMap, DetectorHits& hits, DetectorContext& context) const;
+		void IsBarrel2(NucleusRecord& nucleus, const PCHit& pcResult, const DeadChannelMap& deadMap, DetectorHits& hits, DetectorContext& context) const;
+		void IsQQQ(NucleusRecord& nucleus, const PCHit& pcResult, const DeadChannelMap& deadMap, DetectorHits& hits, DetectorContext& context) const;
 
 		std::vector<SX3Detector> m_barrel1;
 		std::vector<SX3Detector> m_barrel2;
 		std::vector<QQQDetector> m_qqq;
+		PlaneTable m_planes; //Flat copy of the detector planes used for hit finding
 
 		Target m_detectorEloss;
 		Target m_gasEloss;
 
 		ROOT::Math::XYZPoint m_nullPoint;
+		double m_barrelRhoMin; //smallest perpendicular distance from beam axis to a barrel detector
 
 		DeadChannelMap m_deadMap;
+		DeadChannelMap m_liveMap; //every channel alive, used for fan-out
+
+		AnasenGeometry m_geometry;
+		double m_qqqZMin; //closest QQQ plane to the target
 
-		/**** ANASEN geometry constants *****/
 		static constexpr double s_epsilon = 1.0e-6; //accuracy
-		static constexpr int s_nSX3PerBarrel = 12;
-		static constexpr int s_nQQQ = 4;
-		static constexpr double s_sx3Length = 0.075;
-		static constexpr double s_barrelGap = 0.0254;  //Space between edge of frames of each SX3 barrel
-		static constexpr double s_sx3FrameGap = 0.049; //0.049 is empty space due to width of SX3 barrel frame
-		static constexpr double s_totalLength = 0.554; //total length of the ANASEN chamber
-		static constexpr double s_qqqZ = s_totalLength;
-		static constexpr double s_barrel1Z = s_qqqZ - (0.025 + s_sx3Length * 0.5);
-		static constexpr double s_barrel2Z = s_qqqZ - (0.149 + s_sx3FrameGap * 0.5);
-		static constexpr double s_qqqZList[4] = {s_qqqZ, s_qqqZ, s_qqqZ, s_qqqZ};
-		static constexpr double s_qqqPhiList[4] = {5.49779, 0.785398, 2.35619, 3.92699};
-		static constexpr double s_barrelRhoList[12] = {0.0890601, 0.0889871, 0.0890354, 0.0890247, 0.0890354, 0.0890354, 0.0890247,
-													 0.0890354, 0.0890354, 0.0890247, 0.0890354, 0.0890354};
-		static constexpr double s_barrelPhiList[12] = {4.97426, 5.49739, 6.02132, 0.261868, 0.785398, 1.30893, 1.83266, 2.35619, 2.87972, 
-													   3.40346, 3.92699, 4.45052};
-		/*************************/
+		static constexpr int s_nSX3PerBarrel = AnasenGeometry::s_nSX3PerBarrel;
+		static constexpr int s_nQQQ = AnasenGeometry::s_nQQQ;
+		static constexpr double s_totalLength = AnasenGeometry::s_totalLength;
 
 		static constexpr double s_energyThreshold = 0.6; //MeV
 		static constexpr double s_deg2rad = M_PI/180.0;
 		static constexpr double s_detectorDensity = 2.33; //g/cm^3, Si crystal
 		static constexpr double s_detectorThickness = 0.001; //m
+		static constexpr double s_maxSmearDistance = 0.01; //m, largest pixel dimension (SX3 front strip width)
+		static constexpr double s_rangeTolerance = 0.02; //fractional safety margin on tabulated ranges
 	};
 
 }
@@ -0,0 +1,149 @@
+#include "AnasenGeometry.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace AnasenSim {
+
+	//Add value to (or set) list[index], or every entry if index is "all"
+	static bool ApplyIndexed(const std::string& index, double value, double* list, int size, bool isOffset)
+	{
+		if(index == "all")
+		{
+			for(int i=0; i<size; i++)
+				list[i] = isOffset ? list[i] + value : value;
+			return true;
+		}
+
+		char* end = nullptr;
+		long i = std::strtol(index.c_str(), &end, 10);
+		if(end == index.c_str() || *end != '\0' || i < 0 || i >= size)
+			return false;
+		list[i] = isOffset ? list[i] + value : value;
+		return true;
+	}
+
+	bool ReadGeometryFile(const std::string& filename, AnasenGeometry& geometry)
+	{
+		std::ifstream input(filename);
+		if(!input.is_open())
+		{
+			std::cerr << "Unable to open geometry file " << filename << std::endl;
+			return false;
+		}
+
+		AnasenGeometry result;
+		std::string junk, index;
+		double value;
+		while(input >> junk)
+		{
+			if(junk[0] == '#')
+			{
+				std::getline(input, junk);
+				continue;
+			}
+
+			bool isValid = true;
+			if(junk == "Barrel1Z:")
+				isValid = bool(input >> result.barrel1Z);
+			else if(junk == "Barrel2Z:")
+				isValid = bool(input >> result.barrel2Z);
+			else if(junk == "BarrelRho:")
+				isValid = (input >> index >> value) && ApplyIndexed(index, value, result.barrelRhoList, AnasenGeometry::s_nSX3PerBarrel, false);
+			else if(junk == "BarrelPhi:")
+				isValid = (input >> index >> value) && ApplyIndexed(index, value, result.barrelPhiList, AnasenGeometry::s_nSX3PerBarrel, false);
+			else if(junk == "QQQZ:")
+				isValid = (input >> index >> value) && ApplyIndexed(index, value, result.qqqZList, AnasenGeometry::s_nQQQ, false);
+			else if(junk == "QQQPhi:")
+				isValid = (input >> index >> value) && ApplyIndexed(index, value, result.qqqPhiList, AnasenGeometry::s_nQQQ, false);
+			else
+				isValid = false;
+
+			if(!isValid)
+			{
+				std::cerr << "Error parsing geometry file " << filename << "! Bad entry " << junk << std::endl;
+				return false;
+			}
+		}
+
+		geometry = result;
+		return true;
+	}
+
+	bool ReadGeometryEnsemble(const std::string& filename, const AnasenGeometry& nominal, std::vector<GeometryVariant>& variants)
+	{
+		variants.clear();
+		std::ifstream input(filename);
+		if(!input.is_open())
+		{
+			std::cerr << "Unable to open geometry ensemble file " << filename << std::endl;
+			return false;
+		}
+
+		std::string junk, index;
+		double value;
+		GeometryVariant* current = nullptr;
+		while(input >> junk)
+		{
+			if(junk[0] == '#')
+			{
+				std::getline(input, junk);
+				continue;
+			}
+			else if(junk == "begin_variant")
+			{
+				variants.emplace_back();
+				current = &variants.back();
+				current->geometry = nominal;
+				input >> current->name;
+				continue;
+			}
+			else if(junk == "end_variant")
+			{
+				current = nullptr;
+				continue;
+			}
+			else if(current == nullptr)
+			{
+				std::cerr << "Error parsing geometry ensemble! " << junk << " found outside of a variant" << std::endl;
+				variants.clear();
+				return false;
+			}
+
+			bool isValid = true;
+			AnasenGeometry& geometry = current->geometry;
+			if(junk == "Barrel1ZOffset:")
+			{
+				isValid = bool(input >> value);
+				geometry.barrel1Z += value;
+			}
+			else if(junk == "Barrel2ZOffset:")
+			{
+				isValid = bool(input >> value);
+				geometry.barrel2Z += value;
+			}
+			else if(junk == "BarrelRhoOffset:")
+				isValid = (input >> index >> value) && ApplyIndexed(index, value, geometry.barrelRhoList, AnasenGeometry::s_nSX3PerBarrel, true);
+			else if(junk == "QQQZOffset:")
+				isValid = (input >> index >> value) && ApplyIndexed(index, value, geometry.qqqZList, AnasenGeometry::s_nQQQ, true);
+			else
+				isValid = false;
+
+			if(!isValid)
+			{
+				std::cerr << "Error parsing geometry ensemble! Bad entry " << junk << " in variant " << current->name << std::endl;
+				variants.clear();
+				return false;
+			}
+		}
+
+		if(variants.empty())
+		{
+			std::cerr << "Geometry ensemble file " << filename << " contains no variants" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+}
@@ -0,0 +1,69 @@
+/*
+	AnasenGeometry.h
+	Runtime description of the ANASEN silicon positions. The defaults are the nominal (as-built) positions, which a
+	geometry file may replace; a geometry ensemble file lists named variants as offsets from nominal, used to push the
+	same events through perturbed geometries for alignment systematics.
+
+	Geometry file format (distances in m, angles in radians, # starts a comment line). Entries not given keep their default:
+
+	Barrel1Z: <value>
+	Barrel2Z: <value>
+	BarrelRho: <detector index or all> <value>
+	BarrelPhi: <detector index or all> <value>
+	QQQZ: <detector index or all> <value>
+	QQQPhi: <detector index or all> <value>
+
+	Ensemble file format (distances in m, # starts a comment line):
+
+	begin_variant <name>
+		Barrel1ZOffset: <value>
+		Barrel2ZOffset: <value>
+		BarrelRhoOffset: <detector index or all> <value>
+		QQQZOffset: <detector index or all> <value>
+	end_variant
+
+	Any number of offset lines may be given per variant, and repeated offsets add.
+*/
+#ifndef ANASEN_GEOMETRY_H
+#define ANASEN_GEOMETRY_H
+
+#include <string>
+#include <vector>
+
+namespace AnasenSim {
+
+	struct AnasenGeometry
+	{
+		static constexpr int s_nSX3PerBarrel = 12;
+		static constexpr int s_nQQQ = 4;
+		static constexpr double s_sx3Length = 0.075;
+		static constexpr double s_barrelGap = 0.0254;  //Space between edge of frames of each SX3 barrel
+		static constexpr double s_sx3FrameGap = 0.049; //0.049 is empty space due to width of SX3 barrel frame
+		static constexpr double s_totalLength = 0.554; //total length of the ANASEN chamber
+		static constexpr double s_nominalQQQZ = s_totalLength;
+
+		double barrel1Z = s_nominalQQQZ - (0.025 + s_sx3Length * 0.5);
+		double barrel2Z = s_nominalQQQZ - (0.149 + s_sx3FrameGap * 0.5);
+		double qqqZList[s_nQQQ] = {s_nominalQQQZ, s_nominalQQQZ, s_nominalQQQZ, s_nominalQQQZ};
+		double qqqPhiList[s_nQQQ] = {5.49779, 0.785398, 2.35619, 3.92699};
+		double barrelRhoList[s_nSX3PerBarrel] = {0.0890601, 0.0889871, 0.0890354, 0.0890247, 0.0890354, 0.0890354, 0.0890247,
+												 0.0890354, 0.0890354, 0.0890247, 0.0890354, 0.0890354};
+		double barrelPhiList[s_nSX3PerBarrel] = {4.97426, 5.49739, 6.02132, 0.261868, 0.785398, 1.30893, 1.83266, 2.35619, 2.87972,
+												 3.40346, 3.92699, 4.45052};
+	};
+
+	struct GeometryVariant
+	{
+		std::string name;
+		AnasenGeometry geometry;
+	};
+
+	//Returns false (and leaves geometry unchanged) if the file could not be read or parsed
+	bool ReadGeometryFile(const std::string& filename, AnasenGeometry& geometry);
+
+	//Variants are offsets from nominal. Returns false (and leaves variants empty) if the file could not be read or parsed
+	bool ReadGeometryEnsemble(const std::string& filename, const AnasenGeometry& nominal, std::vector<GeometryVariant>& variants);
+
+}
+
+#endif
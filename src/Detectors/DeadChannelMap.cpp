@@ -1,5 +1,4 @@
 #include "DeadChannelMap.h"
-#include "Utils/UUID.h"
 #include <fstream>
 #include <iostream>
 
@@ -11,6 +10,8 @@ namespace AnasenSim {
             return DeadChannelMap::DetectorType::Barrel1;
         else if (type == "barrel2")
             return DeadChannelMap::DetectorType::Barrel2;
+        else if (type == "qqq")
+            return DeadChannelMap::DetectorType::QQQ;
         else if (type == "pc")
             return DeadChannelMap::DetectorType::PC;
         else
@@ -23,6 +24,10 @@ namespace AnasenSim {
             return DeadChannelMap::ChannelType::Front;
         else if (type == "back")
             return DeadChannelMap::ChannelType::Back;
+        else if (type == "ring")
+            return DeadChannelMap::ChannelType::Ring;
+        else if (type == "wedge")
+            return DeadChannelMap::ChannelType::Wedge;
         else if (type == "wire")
             return DeadChannelMap::ChannelType::Wire;
         else
@@ -32,12 +37,77 @@ namespace AnasenSim {
     DeadChannelMap::DeadChannelMap() :
         m_isValid(false)
     {
+        Reset();
     }
 
     DeadChannelMap::~DeadChannelMap() {}
 
+    //Everything alive
+    void DeadChannelMap::Reset()
+    {
+        for(uint32_t b=0; b<2; b++)
+        {
+            for(uint32_t i=0; i<s_nSX3PerBarrel; i++)
+            {
+                m_barrelFrontDead[b][i] = 0;
+                m_barrelBackDead[b][i] = 0;
+            }
+        }
+        for(uint32_t i=0; i<s_nQQQ; i++)
+        {
+            m_qqqRingDead[i] = 0;
+            m_qqqWedgeDead[i] = 0;
+        }
+        m_pcLiveMask = ~0u;
+        BuildLiveMasks();
+    }
+
+    //A pixel is alive only if both its front and back channels are alive
+    void DeadChannelMap::BuildLiveMasks()
+    {
+        for(uint32_t b=0; b<2; b++)
+        {
+            for(uint32_t i=0; i<s_nSX3PerBarrel; i++)
+            {
+                uint32_t mask = 0;
+                bool isLastFrontDead = (m_barrelFrontDead[b][i] >> (s_nSX3Strips - 1)) & 1u;
+                for(uint32_t f=0; f<s_nSX3Strips; f++)
+                {
+                    if((m_barrelFrontDead[b][i] >> f) & 1u)
+                        continue;
+                    for(uint32_t k=0; k<s_nSX3Strips; k++)
+                    {
+                        if(!((m_barrelBackDead[b][i] >> k) & 1u))
+                            mask |= (1u << GetBarrelBit(f, k));
+                    }
+                    if(!isLastFrontDead)
+                        mask |= (1u << GetBarrelBit(f, s_nSX3Strips));
+                }
+                m_barrelLiveMask[b][i] = mask;
+            }
+        }
+
+        for(uint32_t i=0; i<s_nQQQ; i++)
+        {
+            for(uint32_t w=0; w<s_nQQQWords; w++)
+                m_qqqLiveMask[i][w] = 0;
+            for(uint32_t r=0; r<s_nQQQRings; r++)
+            {
+                for(uint32_t w=0; w<s_nQQQWedges; w++)
+                {
+                    if(!((m_qqqRingDead[i] >> r) & 1u) && !((m_qqqWedgeDead[i] >> w) & 1u))
+                    {
+                        uint32_t bit = r * s_nQQQWedges + w;
+                        m_qqqLiveMask[i][bit >> 6] |= (uint64_t(1) << (bit & 63u));
+                    }
+                }
+            }
+        }
+    }
+
     void DeadChannelMap::ReadFile(const std::string& filename)
     {
+        Reset();
         std::ifstream input(filename);
         if(!input.is_open())
         {
@@ -46,7 +116,7 @@ namespace AnasenSim {
         }
         std::string junk;
         std::getline(input, junk);
-        uint32_t detid, channel, uuid;
+        uint32_t detid, channel;
         DetectorType detType;
         ChannelType chanType;
         while(input >> detid)
@@ -60,121 +130,85 @@ namespace AnasenSim {
             {
                 std::cerr << "Error parsing dead channel map! Unidentified detector type" << std::endl;
                 m_isValid = false;
+                Reset();
                 return;
             }
-            else if(detType == DetectorType::Barrel1)
+            else if(chanType == ChannelType::None)
             {
-                if(chanType == ChannelType::None)
+                std::cerr << "Error parsing dead channel map! Unidentified channel type" << std::endl;
+                m_isValid = false;
+                Reset();
+                return;
+            }
+            else if(detType == DetectorType::Barrel1 || detType == DetectorType::Barrel2)
+            {
+                uint32_t barrel = detType == DetectorType::Barrel1 ? 0 : 1;
+                if(detid >= s_nSX3PerBarrel || channel >= s_nSX3Strips)
                 {
-                    std::cerr << "Error parsing dead channel map! Unidentified channel type" << std::endl;
+                    std::cerr << "Error parsing dead channel map! Barrel channel out of range" << std::endl;
                     m_isValid = false;
+                    Reset();
                     return;
                 }
-                else if (chanType == ChannelType::Back)
-                {
-                    channel += s_sx3BackChannelOffset;
-                }
-                m_barrel1Map[GetUUID(detid, channel)] = true;
+                if(chanType == ChannelType::Back)
+                    m_barrelBackDead[barrel][detid] |= (1u << channel);
+                else
+                    m_barrelFrontDead[barrel][detid] |= (1u << channel);
             }
-            else if(detType == DetectorType::Barrel2)
+            else if(detType == DetectorType::QQQ)
             {
-                if (chanType == ChannelType::None)
+                if(detid >= s_nQQQ || channel >= s_nQQQRings)
                 {
-                    std::cerr << "Error parsing dead channel map! Unidentified channel type" << std::endl;
+                    std::cerr << "Error parsing dead channel map! QQQ channel out of range" << std::endl;
                     m_isValid = false;
+                    Reset();
                     return;
                 }
-                else if (chanType == ChannelType::Back)
-                {
-                   channel += s_sx3BackChannelOffset;
-                }
-                m_barrel2Map[GetUUID(detid, channel)] = true;
+                if(chanType == ChannelType::Back || chanType == ChannelType::Wedge)
+                    m_qqqWedgeDead[detid] |= (1u << channel);
+                else
+                    m_qqqRingDead[detid] |= (1u << channel);
             }
             else if(detType == DetectorType::PC)
             {
-                if (chanType == ChannelType::None)
-                {
-                    std::cerr << "Error parsing dead channel map! Unidentified channel type" << std::endl;
-                    m_isValid = false;
-                    return;
-                }
-                m_pcMap[GetUUID(s_pcDetID, channel)] = true;
+                if(channel < s_nWireBits)
+                    m_pcLiveMask &= ~(1u << channel);
             }
         }
 
         input.close();
+        BuildLiveMasks();
         m_isValid = true;
     }
 
-    bool DeadChannelMap::IsWireDead(uint32_t wireID) const 
-    {
-        if(!m_isValid)
-            return false;
-        auto iter = m_pcMap.find(GetUUID(s_pcDetID, wireID));
-        if (iter != m_pcMap.end())
-            return true;
-        return false;
-    }
-
     bool DeadChannelMap::IsChannelDead(uint32_t detid, uint32_t channelid, DetectorType dettype, ChannelType chantype) const
     {
-        if(!m_isValid)
-            return false;
-
-        if (dettype == DetectorType::Barrel1)
+        switch(dettype)
         {
-            if (chantype == ChannelType::Back)
+            case DetectorType::Barrel1:
+            case DetectorType::Barrel2:
             {
-                channelid += s_sx3BackChannelOffset;
+                uint32_t barrel = dettype == DetectorType::Barrel1 ? 0 : 1;
+                if(detid >= s_nSX3PerBarrel || channelid >= s_nSX3Strips)
+                    return false;
+                if(chantype == ChannelType::Back)
+                    return (m_barrelBackDead[barrel][detid] >> channelid) & 1u;
+                else
+                    return (m_barrelFrontDead[barrel][detid] >> channelid) & 1u;
             }
-            auto iter = m_barrel1Map.find(GetUUID(detid, channelid));
-            if(iter == m_barrel1Map.end())
-                return false;
-            else
-                return true;
-        }
-        else if (dettype == DetectorType::Barrel2)
-        {
-            if (chantype == ChannelType::Back)
+            case DetectorType::QQQ:
             {
-                channelid += s_sx3BackChannelOffset;
+                if(detid >= s_nQQQ || channelid >= s_nQQQRings)
+                    return false;
+                if(chantype == ChannelType::Back || chantype == ChannelType::Wedge)
+                    return (m_qqqWedgeDead[detid] >> channelid) & 1u;
+                else
+                    return (m_qqqRingDead[detid] >> channelid) & 1u;
             }
-            auto iter = m_barrel2Map.find(GetUUID(detid, channelid));
-            if(iter == m_barrel2Map.end())
+            case DetectorType::PC:
+                return IsWireDead(channelid);
+            default:
                 return false;
-            else
-                return true;
         }
-
-        return false;
-    }
-
-    bool DeadChannelMap::IsChannelPairDead(uint32_t detid, uint32_t channelfront, uint32_t channelback, DetectorType dettype) const
-    {
-        if(!m_isValid)
-            return false;
-            
-        if (dettype == DetectorType::Barrel1)
-        {
-            channelback += s_sx3BackChannelOffset;
-            auto iterfront = m_barrel1Map.find(GetUUID(detid, channelfront));
-            auto iterback = m_barrel1Map.find(GetUUID(detid, channelback));
-            if(iterfront == m_barrel1Map.end() && iterback == m_barrel1Map.end())
-                return false;
-            else
-                return true;
-        }
-        else if (dettype == DetectorType::Barrel2)
-        {
-            channelback += s_sx3BackChannelOffset;
-            auto iterfront = m_barrel2Map.find(GetUUID(detid, channelfront));
-            auto iterback = m_barrel2Map.find(GetUUID(detid, channelback));
-            if(iterfront == m_barrel2Map.end() && iterback == m_barrel2Map.end())
-                return false;
-            else
-                return true;
-        }
-
-        return false;
     }
 }
\ No newline at end of file
@@ -2,11 +2,15 @@
 #define DEAD_CHANNEL_MAP_H
 
 #include <cstdint>
-#include <unordered_map>
 #include <string>
 
 namespace AnasenSim {
 
+    /*
+        Dead channels are stored as flat bitmasks. After a file is read, a live-pair mask is precomputed for every
+        detector, with one bit per (front, back) pixel, so the hot-path checks are a single load-and-test.
+        A map which failed to load reports every channel as alive.
+    */
     class DeadChannelMap
     {
     public:
@@ -15,6 +19,7 @@ namespace AnasenSim {
         {
             Barrel1,
             Barrel2,
+            QQQ,
             PC,
             None
         };
@@ -23,6 +28,8 @@ namespace AnasenSim {
         {
             Front,
             Back,
+            Ring,
+            Wedge,
             Wire,
             None
         };
@@ -33,25 +40,70 @@ namespace AnasenSim {
         void ReadFile(const std::string& filename);
 
         //Return true if wire is dead, false if wire is alive
-        bool IsWireDead(uint32_t wireid) const;
+        bool IsWireDead(uint32_t wireid) const
+        {
+            return wireid < s_nWireBits && !((m_pcLiveMask >> wireid) & 1u);
+        }
         //Methods for Si
         //Return true if channel is dead, false if channel is alive
         bool IsChannelDead(uint32_t detid, uint32_t channelid, DetectorType dettype, ChannelType chantype) const;
-        //Return true if channel pair is dead, false if channel pair is alive
-        bool IsChannelPairDead(uint32_t detid, uint32_t channelfront, uint32_t channelback, DetectorType dettype) const;
+        //Return true if channel pair is dead, false if channel pair is alive. For QQQ front is ring, back is wedge.
+        bool IsChannelPairDead(uint32_t detid, uint32_t channelfront, uint32_t channelback, DetectorType dettype) const
+        {
+            switch(dettype)
+            {
+                case DetectorType::Barrel1:
+                    return detid < s_nSX3PerBarrel && !((m_barrelLiveMask[0][detid] >> GetBarrelBit(channelfront, channelback)) & 1u);
+                case DetectorType::Barrel2:
+                    return detid < s_nSX3PerBarrel && !((m_barrelLiveMask[1][detid] >> GetBarrelBit(channelfront, channelback)) & 1u);
+                case DetectorType::QQQ:
+                {
+                    uint32_t bit = channelfront * s_nQQQWedges + channelback;
+                    return detid < s_nQQQ && !((m_qqqLiveMask[detid][bit >> 6] >> (bit & 63u)) & 1u);
+                }
+                default:
+                    return false;
+            }
+        }
 
         bool IsValid() const { return m_isValid; }
 
     private:
-        std::unordered_map<uint32_t, bool> m_barrel1Map;
-        std::unordered_map<uint32_t, bool> m_barrel2Map;
-        std::unordered_map<uint32_t, bool> m_pcMap;
-        bool m_isValid;
+        void Reset();
+        void BuildLiveMasks();
+
+        /*
+            SX3Detector::GetChannelRatio can find a front strip without a back strip (back = -1). The original keyed lookup
+            resolved that case to front strip 3, so it gets its own column (s_nSX3Strips) in the live mask to keep results unchanged.
+        */
+        static uint32_t GetBarrelBit(uint32_t channelfront, uint32_t channelback)
+        {
+            return channelfront * s_nSX3Columns + (channelback < s_nSX3Strips ? channelback : s_nSX3Strips);
+        }
 
-        static constexpr uint32_t s_sx3BackChannelOffset = 4;
-        static constexpr uint32_t s_pcDetID = 99;
+        static constexpr uint32_t s_nSX3PerBarrel = 12;
+        static constexpr uint32_t s_nSX3Strips = 4; //Same for front and back
+        static constexpr uint32_t s_nSX3Columns = s_nSX3Strips + 1; //back strips plus the missing back strip case
+        static constexpr uint32_t s_nQQQ = 4;
+        static constexpr uint32_t s_nQQQRings = 16;
+        static constexpr uint32_t s_nQQQWedges = 16;
+        static constexpr uint32_t s_nQQQWords = s_nQQQRings * s_nQQQWedges / 64;
+        static constexpr uint32_t s_nWireBits = 32; //24 wires, extra bits stay alive
+
+        //Dead bits per channel, as read from file
+        uint8_t m_barrelFrontDead[2][s_nSX3PerBarrel];
+        uint8_t m_barrelBackDead[2][s_nSX3PerBarrel];
+        uint16_t m_qqqRingDead[s_nQQQ];
+        uint16_t m_qqqWedgeDead[s_nQQQ];
+
+        //Precomputed live masks used by the hot path
+        uint32_t m_barrelLiveMask[2][s_nSX3PerBarrel]; //bit front*5 + back
+        uint64_t m_qqqLiveMask[s_nQQQ][s_nQQQWords]; //bit ring*16 + wedge
+        uint32_t m_pcLiveMask; //bit wire
+
+        bool m_isValid;
     };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,47 @@
+/*
+	DetectorContext.h
+	Per-thread mutable state for AnasenArray: the random generator used for detector smearing and scratch buffers which are
+	reused between events. AnasenArray is read-only during detection, so a single array can be shared by any number of
+	threads provided each thread passes its own context.
+*/
+#ifndef DETECTOR_CONTEXT_H
+#define DETECTOR_CONTEXT_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "PCDetector.h"
+
+namespace AnasenSim {
+
+	struct DetectorContext
+	{
+		DetectorContext() :
+			generator(std::random_device()())
+		{
+		}
+
+		explicit DetectorContext(uint64_t seed) :
+			generator(seed)
+		{
+		}
+
+		double GetUniformFraction() { return uniform(generator); }
+
+		std::mt19937_64 generator;
+		std::uniform_real_distribution<double> uniform{0.0, 1.0};
+
+		//Batched PC assignment, one entry per nucleus of the current event
+		std::vector<uint8_t> isCandidate;
+		std::vector<PCHit> pcHits;
+		//Batched PC assignment, one entry per candidate
+		std::vector<PCHit> pcBatchHits;
+		std::vector<double> pcRxnX, pcRxnY, pcRxnZ;
+		std::vector<double> pcDirX, pcDirY, pcDirZ;
+		std::vector<uint32_t> pcZ;
+	};
+
+}
+
+#endif
@@ -0,0 +1,378 @@
+#include "DetectorValidation.h"
+#include "Utils/Timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace AnasenSim {
+
+	bool ReadValidationSettings(const std::string& filename, ValidationSettings& settings)
+	{
+		std::ifstream input(filename);
+		if(!input.is_open())
+		{
+			std::cerr << "Unable to open validation settings file " << filename << std::endl;
+			return false;
+		}
+
+		ValidationSettings result = settings;
+		std::string junk;
+		while(input >> junk)
+		{
+			if(junk[0] == '#')
+			{
+				std::getline(input, junk);
+				continue;
+			}
+
+			bool isValid = true;
+			if(junk == "NumberOfTrajectories:")
+				isValid = bool(input >> result.nTrajectories);
+			else if(junk == "NumberOfEnergyTrials:")
+				isValid = bool(input >> result.nEnergyTrials);
+			else if(junk == "Seed:")
+				isValid = bool(input >> result.seed);
+			else if(junk == "VertexRhoMax(m):")
+				isValid = bool(input >> result.vertexRhoMax);
+			else if(junk == "MinEnergy(MeV):")
+				isValid = bool(input >> result.minEnergy);
+			else if(junk == "MaxEnergy(MeV):")
+				isValid = bool(input >> result.maxEnergy);
+			else if(junk == "MaxGasPath(m):")
+				isValid = bool(input >> result.maxGasPath);
+			else if(junk == "MaxSX3MismatchRate:")
+				isValid = bool(input >> result.maxSX3MismatchRate);
+			else if(junk == "MaxQQQMismatchRate:")
+				isValid = bool(input >> result.maxQQQMismatchRate);
+			else if(junk == "MaxPCMismatchRate:")
+				isValid = bool(input >> result.maxPCMismatchRate);
+			else if(junk == "MaxEnergyLossMismatchRate:")
+				isValid = bool(input >> result.maxEnergyLossMismatchRate);
+			else if(junk == "MaxEnergyDeviation(MeV):")
+				isValid = bool(input >> result.maxEnergyDeviation);
+			else
+				isValid = false;
+
+			if(!isValid)
+			{
+				std::cerr << "Error parsing validation settings file " << filename << "! Bad entry " << junk << std::endl;
+				return false;
+			}
+		}
+
+		settings = result;
+		return true;
+	}
+
+	DetectorValidation::DetectorValidation(const Target& gas, const AnasenGeometry& geometry, const ValidationSettings& settings) :
+		m_settings(settings), m_generator(settings.seed), m_gas(gas), m_silicon({14}, {28}, {1}, s_siliconDensity)
+	{
+		for(int i=0; i<AnasenGeometry::s_nSX3PerBarrel; i++)
+		{
+			m_barrel1.emplace_back(geometry.barrelPhiList[i], geometry.barrel1Z, geometry.barrelRhoList[i]);
+			m_barrel2.emplace_back(geometry.barrelPhiList[i], geometry.barrel2Z, geometry.barrelRhoList[i]);
+		}
+		for(int i=0; i<AnasenGeometry::s_nQQQ; i++)
+			m_qqq.emplace_back(geometry.qqqPhiList[i], geometry.qqqZList[i]);
+		m_planes = PlaneTable(m_barrel1, m_barrel2, m_qqq);
+	}
+
+	DetectorValidation::~DetectorValidation() {}
+
+	/*
+		Geometry checks run over blocks of random trajectories; every implementation sees the same block and is timed
+		separately. Energy loss uses its own trial count, as the catima reference is orders of magnitude slower.
+	*/
+	bool DetectorValidation::Run(const std::vector<NucleusRecord>& nuclei)
+	{
+		std::vector<NucleusRecord> species;
+		for(const NucleusRecord& nucleus : nuclei)
+		{
+			if(nucleus.role == Nucleus::ReactionRole::Target || nucleus.role == Nucleus::ReactionRole::Projectile)
+				continue;
+			auto iter = std::find_if(species.begin(), species.end(), [&nucleus](const NucleusRecord& other)
+			{
+				return other.Z == nucleus.Z && other.A == nucleus.A;
+			});
+			if(iter == species.end())
+				species.push_back(nucleus);
+		}
+
+		ValidationResult barrel1, barrel2, qqq, pc, gasEloss, siliconEloss;
+		barrel1.name = "SX3 barrel 1";
+		barrel1.maxMismatchRate = m_settings.maxSX3MismatchRate;
+		barrel2.name = "SX3 barrel 2";
+		barrel2.maxMismatchRate = m_settings.maxSX3MismatchRate;
+		qqq.name = "QQQ";
+		qqq.maxMismatchRate = m_settings.maxQQQMismatchRate;
+		pc.name = "PC";
+		pc.maxMismatchRate = m_settings.maxPCMismatchRate;
+		gasEloss.name = "Gas energy loss";
+		gasEloss.maxMismatchRate = m_settings.maxEnergyLossMismatchRate;
+		siliconEloss.name = "Si energy loss";
+		siliconEloss.maxMismatchRate = m_settings.maxEnergyLossMismatchRate;
+
+		std::cout << "Validating fast detector paths with " << m_settings.nTrajectories << " trajectories and " << m_settings.nEnergyTrials
+				  << " energy loss trials (seed " << m_settings.seed << ")" << std::endl;
+
+		for(uint64_t nDone = 0; nDone < m_settings.nTrajectories; nDone += m_trajectories.size())
+		{
+			GenerateTrajectories(std::min<uint64_t>(s_trajectoryBlock, m_settings.nTrajectories - nDone));
+			ValidateSX3(PlaneTable::Barrel1, m_barrel1, barrel1);
+			ValidateSX3(PlaneTable::Barrel2, m_barrel2, barrel2);
+			ValidateQQQ(qqq);
+			ValidatePC(pc);
+		}
+
+		Target gasTables = m_gas;
+		Target siliconTables = m_silicon;
+		for(const NucleusRecord& nucleus : species)
+		{
+			gasTables.InitRangeTable(nucleus.Z, nucleus.A);
+			siliconTables.InitRangeTable(nucleus.Z, nucleus.A);
+		}
+		if(!species.empty())
+		{
+			ValidateEnergyLoss(m_gas, gasTables, m_settings.maxGasPath, species, gasEloss);
+			ValidateEnergyLoss(m_silicon, siliconTables, s_maxSiliconPath, species, siliconEloss);
+		}
+
+		std::cout << std::left << std::setw(18) << "Check" << std::right << std::setw(12) << "Trials" << std::setw(12) << "Mismatches"
+				  << std::setw(14) << "Rate" << std::setw(14) << "MaxDeviation" << std::setw(14) << "Ref (1/s)" << std::setw(14) << "Fast (1/s)"
+				  << std::setw(8) << "Result" << std::endl;
+		bool isPassed = true;
+		for(const ValidationResult* result : {&barrel1, &barrel2, &qqq, &pc, &gasEloss, &siliconEloss})
+		{
+			PrintResult(*result);
+			isPassed &= result->IsPassed();
+		}
+
+		std::cout << (isPassed ? "Validation passed" : "Validation FAILED") << std::endl;
+		return isPassed;
+	}
+
+	//Vertices uniform over a disk of radius vertexRhoMax along (and slightly beyond) the chamber, directions isotropic
+	void DetectorValidation::GenerateTrajectories(std::size_t nTrajectories)
+	{
+		std::uniform_real_distribution<double> uniform(0.0, 1.0);
+		m_trajectories.resize(nTrajectories);
+		for(Trajectory& trajectory : m_trajectories)
+		{
+			double rho = m_settings.vertexRhoMax * std::sqrt(uniform(m_generator));
+			double vertexPhi = 2.0 * M_PI * uniform(m_generator);
+			double z = -0.05 + (AnasenGeometry::s_totalLength + 0.1) * uniform(m_generator);
+			trajectory.vertex.SetXYZ(rho * std::cos(vertexPhi), rho * std::sin(vertexPhi), z);
+			trajectory.theta = std::acos(1.0 - 2.0 * uniform(m_generator));
+			trajectory.phi = M_PI * (2.0 * uniform(m_generator) - 1.0); //Same range as ROOT Phi(), as used for detected nuclei
+		}
+	}
+
+	//A trajectory mismatches if any detector of the layer gives a different strip pair or ratio
+	void DetectorValidation::ValidateSX3(PlaneTable::Layer layer, const std::vector<SX3Detector>& barrel, ValidationResult& result)
+	{
+		const std::size_t nTrajectories = m_trajectories.size();
+		const std::size_t nDetectors = barrel.size();
+		m_referenceSX3.resize(nTrajectories * nDetectors);
+		m_fastSX3.resize(nTrajectories * nDetectors);
+
+		Timer timer;
+		timer.Start();
+		for(std::size_t i=0; i<nTrajectories; i++)
+		{
+			const Trajectory& trajectory = m_trajectories[i];
+			for(std::size_t j=0; j<nDetectors; j++)
+				m_referenceSX3[i * nDetectors + j] = barrel[j].GetChannelRatio(trajectory.vertex, trajectory.theta, trajectory.phi);
+		}
+		timer.Stop();
+		result.referenceTime += timer.GetElapsedSeconds();
+
+		timer.Start();
+		for(std::size_t i=0; i<nTrajectories; i++)
+		{
+			const Trajectory& trajectory = m_trajectories[i];
+			m_planes.IntersectSX3(layer, trajectory.vertex, trajectory.theta, trajectory.phi, &m_fastSX3[i * nDetectors]);
+		}
+		timer.Stop();
+		result.fastTime += timer.GetElapsedSeconds();
+
+		for(std::size_t i=0; i<nTrajectories; i++)
+		{
+			bool isMismatch = false;
+			for(std::size_t j=0; j<nDetectors; j++)
+			{
+				const SX3Hit& reference = m_referenceSX3[i * nDetectors + j];
+				const SX3Hit& fast = m_fastSX3[i * nDetectors + j];
+				if(reference.front_strip_index != fast.front_strip_index || reference.back_strip_index != fast.back_strip_index)
+				{
+					isMismatch = true;
+					continue;
+				}
+				double deviation = std::fabs(reference.front_ratio - fast.front_ratio);
+				result.maxDeviation = std::max(result.maxDeviation, deviation);
+				isMismatch |= deviation != 0.0;
+			}
+			result.nMismatches += isMismatch;
+		}
+		result.nTrials += nTrajectories;
+	}
+
+	void DetectorValidation::ValidateQQQ(ValidationResult& result)
+	{
+		const std::size_t nTrajectories = m_trajectories.size();
+		const std::size_t nDetectors = m_qqq.size();
+		m_referenceQQQ.resize(nTrajectories * nDetectors);
+		m_fastQQQ.resize(nTrajectories * nDetectors);
+
+		Timer timer;
+		timer.Start();
+		for(std::size_t i=0; i<nTrajectories; i++)
+		{
+			const Trajectory& trajectory = m_trajectories[i];
+			for(std::size_t j=0; j<nDetectors; j++)
+				m_referenceQQQ[i * nDetectors + j] = m_qqq[j].GetTrajectoryRingWedge(trajectory.vertex, trajectory.theta, trajectory.phi);
+		}
+		timer.Stop();
+		result.referenceTime += timer.GetElapsedSeconds();
+
+		timer.Start();
+		for(std::size_t i=0; i<nTrajectories; i++)
+		{
+			const Trajectory& trajectory = m_trajectories[i];
+			m_planes.IntersectQQQ(trajectory.vertex, trajectory.theta, trajectory.phi, &m_fastQQQ[i * nDetectors]);
+		}
+		timer.Stop();
+		result.fastTime += timer.GetElapsedSeconds();
+
+		for(std::size_t i=0; i<nTrajectories; i++)
+		{
+			bool isMismatch = false;
+			for(std::size_t j=0; j<nDetectors; j++)
+				isMismatch |= m_referenceQQQ[i * nDetectors + j] != m_fastQQQ[i * nDetectors + j];
+			result.nMismatches += isMismatch;
+		}
+		result.nTrials += nTrajectories;
+	}
+
+	//Both implementations get generators with the same seed, so the z smearing must agree exactly as well
+	void DetectorValidation::ValidatePC(ValidationResult& result)
+	{
+		const std::size_t nTrajectories = m_trajectories.size();
+		m_referencePC.resize(nTrajectories);
+		m_fastPC.resize(nTrajectories);
+		uint64_t smearSeed = m_generator();
+		std::vector<uint32_t> zp(nTrajectories);
+		for(std::size_t i=0; i<nTrajectories; i++)
+			zp[i] = i % 2 == 0 ? 1 : 2;
+
+		Timer timer;
+		std::mt19937_64 referenceGenerator(smearSeed);
+		timer.Start();
+		for(std::size_t i=0; i<nTrajectories; i++)
+		{
+			const Trajectory& trajectory = m_trajectories[i];
+			m_referencePC[i] = PCDetector::AssignPCReference(trajectory.vertex, trajectory.theta, trajectory.phi, zp[i], referenceGenerator);
+		}
+		timer.Stop();
+		result.referenceTime += timer.GetElapsedSeconds();
+
+		//Batch setup is part of the fast path, as in AnasenArray
+		std::mt19937_64 fastGenerator(smearSeed);
+		std::vector<double> rxnX(nTrajectories), rxnY(nTrajectories), rxnZ(nTrajectories);
+		std::vector<double> dirX(nTrajectories), dirY(nTrajectories), dirZ(nTrajectories);
+		timer.Start();
+		for(std::size_t i=0; i<nTrajectories; i++)
+		{
+			const Trajectory& trajectory = m_trajectories[i];
+			rxnX[i] = trajectory.vertex.X();
+			rxnY[i] = trajectory.vertex.Y();
+			rxnZ[i] = trajectory.vertex.Z();
+			dirX[i] = std::sin(trajectory.theta)*std::cos(trajectory.phi);
+			dirY[i] = std::sin(trajectory.theta)*std::sin(trajectory.phi);
+			dirZ[i] = std::cos(trajectory.theta);
+		}
+		PCBatch batch;
+		batch.rxnX = rxnX.data();
+		batch.rxnY = rxnY.data();
+		batch.rxnZ = rxnZ.data();
+		batch.dirX = dirX.data();
+		batch.dirY = dirY.data();
+		batch.dirZ = dirZ.data();
+		batch.zp = zp.data();
+		batch.size = nTrajectories;
+		PCDetector::AssignPC(batch, m_fastPC.data(), fastGenerator);
+		timer.Stop();
+		result.fastTime += timer.GetElapsedSeconds();
+
+		for(std::size_t i=0; i<nTrajectories; i++)
+		{
+			const PCHit& reference = m_referencePC[i];
+			const PCHit& fast = m_fastPC[i];
+			if(reference.wireID != fast.wireID)
+			{
+				result.nMismatches++;
+				continue;
+			}
+			double deviation = std::max({std::fabs(reference.hit.X() - fast.hit.X()), std::fabs(reference.hit.Y() - fast.hit.Y()),
+										 std::fabs(reference.hit.Z() - fast.hit.Z())});
+			result.maxDeviation = std::max(result.maxDeviation, deviation);
+			result.nMismatches += deviation != 0.0;
+		}
+		result.nTrials += nTrajectories;
+	}
+
+	//Residual energy after a random path for a random species and energy. A mismatch is a deviation above maxEnergyDeviation
+	void DetectorValidation::ValidateEnergyLoss(const Target& reference, const Target& fast, double maxPath, const std::vector<NucleusRecord>& species,
+												ValidationResult& result)
+	{
+		std::uniform_real_distribution<double> uniform(0.0, 1.0);
+		std::uniform_int_distribution<std::size_t> pickSpecies(0, species.size() - 1);
+		std::vector<std::size_t> speciesIndex(m_settings.nEnergyTrials);
+		std::vector<double> energies(m_settings.nEnergyTrials), paths(m_settings.nEnergyTrials);
+		std::vector<double> referenceEnergies(m_settings.nEnergyTrials), fastEnergies(m_settings.nEnergyTrials);
+		for(uint64_t i=0; i<m_settings.nEnergyTrials; i++)
+		{
+			speciesIndex[i] = pickSpecies(m_generator);
+			energies[i] = m_settings.minEnergy + (m_settings.maxEnergy - m_settings.minEnergy) * uniform(m_generator);
+			paths[i] = maxPath * uniform(m_generator);
+		}
+
+		Timer timer;
+		timer.Start();
+		for(uint64_t i=0; i<m_settings.nEnergyTrials; i++)
+		{
+			const NucleusRecord& nucleus = species[speciesIndex[i]];
+			referenceEnergies[i] = energies[i] - reference.GetEnergyLoss(nucleus.Z, nucleus.A, energies[i], paths[i]);
+		}
+		timer.Stop();
+		result.referenceTime += timer.GetElapsedSeconds();
+
+		timer.Start();
+		for(uint64_t i=0; i<m_settings.nEnergyTrials; i++)
+		{
+			const NucleusRecord& nucleus = species[speciesIndex[i]];
+			fast.GetEnergiesAlongPath(nucleus.Z, nucleus.A, energies[i], &paths[i], &fastEnergies[i], 1);
+		}
+		timer.Stop();
+		result.fastTime += timer.GetElapsedSeconds();
+
+		for(uint64_t i=0; i<m_settings.nEnergyTrials; i++)
+		{
+			double deviation = std::fabs(referenceEnergies[i] - fastEnergies[i]);
+			result.maxDeviation = std::max(result.maxDeviation, deviation);
+			result.nMismatches += deviation > m_settings.maxEnergyDeviation;
+		}
+		result.nTrials += m_settings.nEnergyTrials;
+	}
+
+	void DetectorValidation::PrintResult(const ValidationResult& result)
+	{
+		std::cout << std::left << std::setw(18) << result.name << std::right << std::setw(12) << result.nTrials << std::setw(12) << result.nMismatches
+				  << std::setw(14) << std::setprecision(4) << result.GetMismatchRate() << std::setw(14) << result.maxDeviation
+				  << std::setw(14) << std::setprecision(6) << result.GetReferenceRate() << std::setw(14) << result.GetFastRate()
+				  << std::setw(8) << (result.IsPassed() ? "PASS" : "FAIL") << std::endl;
+	}
+
+}
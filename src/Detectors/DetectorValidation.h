@@ -0,0 +1,133 @@
+/*
+	DetectorValidation.h
+	Randomized differential check of the fast detector paths against their reference implementations:
+
+	SX3    PlaneTable::IntersectSX3 vs. SX3Detector::GetChannelRatio (both barrels)
+	QQQ    PlaneTable::IntersectQQQ vs. QQQDetector::GetTrajectoryRingWedge
+	PC     PCDetector::AssignPC (batched) vs. PCDetector::AssignPCReference
+	Eloss  RangeTable lookups (Target::GetEnergiesAlongPath with tables) vs. catima integration (Target::GetEnergyLoss),
+		   in the gas and in silicon, for every detectable species of the reaction
+
+	Trajectories start from random vertices and go in random (isotropic) directions. Each check reports the mismatch rate,
+	the largest deviation (front strip ratio for SX3, position in m for PC, energy in MeV for energy loss) and the throughput
+	of both implementations, and fails if the mismatch rate exceeds its configured tolerance. An energy loss trial mismatches
+	if it deviates by more than MaxEnergyDeviation.
+
+	Settings file format (# starts a comment line). Entries not given keep their default:
+
+	NumberOfTrajectories: <value>
+	NumberOfEnergyTrials: <value>
+	Seed: <value>
+	VertexRhoMax(m): <value>
+	MinEnergy(MeV): <value>
+	MaxEnergy(MeV): <value>
+	MaxGasPath(m): <value>
+	MaxSX3MismatchRate: <value>
+	MaxQQQMismatchRate: <value>
+	MaxPCMismatchRate: <value>
+	MaxEnergyDeviation(MeV): <value>
+*/
+#ifndef DETECTOR_VALIDATION_H
+#define DETECTOR_VALIDATION_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SX3Detector.h"
+#include "QQQDetector.h"
+#include "PlaneTable.h"
+#include "PCDetector.h"
+#include "AnasenGeometry.h"
+#include "Sim/Target.h"
+#include "Sim/NucleusRecord.h"
+
+namespace AnasenSim {
+
+	struct ValidationSettings
+	{
+		uint64_t nTrajectories = 1000000;
+		uint64_t nEnergyTrials = 100000; //catima is slow, so energy loss gets its own (smaller) count
+		uint64_t seed = 20240601;
+		double vertexRhoMax = 0.045; //m, a little beyond the PC wires so the miss branch is exercised
+		double minEnergy = 0.1; //MeV
+		double maxEnergy = 30.0; //MeV
+		double maxGasPath = 0.6; //m
+		double maxSX3MismatchRate = 0.0;
+		double maxQQQMismatchRate = 0.0;
+		double maxPCMismatchRate = 0.0;
+		double maxEnergyLossMismatchRate = 0.0; //Trials beyond maxEnergyDeviation, for the gas and silicon energy loss alike
+		double maxEnergyDeviation = 0.005; //MeV
+	};
+
+	//Returns false (and leaves settings unchanged) if the file could not be read or parsed
+	bool ReadValidationSettings(const std::string& filename, ValidationSettings& settings);
+
+	struct ValidationResult
+	{
+		std::string name;
+		uint64_t nTrials = 0;
+		uint64_t nMismatches = 0;
+		double maxDeviation = 0.0;
+		double referenceTime = 0.0; //s
+		double fastTime = 0.0; //s
+		double maxMismatchRate = 0.0;
+
+		double GetMismatchRate() const { return nTrials == 0 ? 0.0 : double(nMismatches)/double(nTrials); }
+		double GetReferenceRate() const { return referenceTime > 0.0 ? nTrials/referenceTime : 0.0; } //trials per second
+		double GetFastRate() const { return fastTime > 0.0 ? nTrials/fastTime : 0.0; } //trials per second
+		bool IsPassed() const { return GetMismatchRate() <= maxMismatchRate; }
+	};
+
+	class DetectorValidation
+	{
+	public:
+		DetectorValidation(const Target& gas, const AnasenGeometry& geometry, const ValidationSettings& settings);
+		~DetectorValidation();
+
+		//Runs every check for the given reaction nuclei and prints a report. Returns true if every check passed
+		bool Run(const std::vector<NucleusRecord>& nuclei);
+
+	private:
+		struct Trajectory
+		{
+			ROOT::Math::XYZPoint vertex;
+			double theta;
+			double phi;
+		};
+
+		void GenerateTrajectories(std::size_t nTrajectories);
+		//Each check adds the current block of trajectories to result
+		void ValidateSX3(PlaneTable::Layer layer, const std::vector<SX3Detector>& barrel, ValidationResult& result);
+		void ValidateQQQ(ValidationResult& result);
+		void ValidatePC(ValidationResult& result);
+		void ValidateEnergyLoss(const Target& reference, const Target& fast, double maxPath, const std::vector<NucleusRecord>& species,
+								ValidationResult& result);
+		void PrintResult(const ValidationResult& result);
+
+		ValidationSettings m_settings;
+		std::mt19937_64 m_generator;
+
+		std::vector<SX3Detector> m_barrel1;
+		std::vector<SX3Detector> m_barrel2;
+		std::vector<QQQDetector> m_qqq;
+		PlaneTable m_planes;
+
+		Target m_gas;
+		Target m_silicon;
+
+		//Current block of trajectories and per-check result scratch, reused between blocks
+		std::vector<Trajectory> m_trajectories;
+		std::vector<SX3Hit> m_referenceSX3, m_fastSX3;
+		std::vector<std::pair<int, int>> m_referenceQQQ, m_fastQQQ;
+		std::vector<PCHit> m_referencePC, m_fastPC;
+
+		static constexpr std::size_t s_trajectoryBlock = 1 << 16; //Trajectories generated and checked at a time
+		static constexpr double s_siliconDensity = 2.33; //g/cm^3
+		static constexpr double s_maxSiliconPath = 0.003; //m, 1 mm detector crossed at up to ~70 degrees
+	};
+
+}
+
+#endif
@@ -1,6 +1,8 @@
 #include "PCDetector.h"
 #include "Sim/SimBase.h"
 
+#include <algorithm>
+
 namespace AnasenSim {
 
     //Works by taking rxn point and assigning PC wire which is closest to rxnPoint. Then z-position is calculated using 
@@ -57,10 +59,88 @@ namespace AnasenSim {
 
     //Find point of nearest approach by checking intersection with cylinder formed by pc wires. Then take nearest PC to intersection, keeping z constant
     //This method I think better captures the idea of the PC, plus no for loops
-    PCHit PCDetector::AssignPC(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, uint32_t zp)
+    PCHit PCDetector::AssignPC(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, uint32_t zp, std::mt19937_64& generator)
+    {
+        double rxnX = rxnPoint.X(), rxnY = rxnPoint.Y(), rxnZ = rxnPoint.Z();
+        double dirX = std::sin(theta)*std::cos(phi), dirY = std::sin(theta)*std::sin(phi), dirZ = std::cos(theta);
+
+        PCBatch batch;
+        batch.rxnX = &rxnX;
+        batch.rxnY = &rxnY;
+        batch.rxnZ = &rxnZ;
+        batch.dirX = &dirX;
+        batch.dirY = &dirY;
+        batch.dirZ = &dirZ;
+        batch.zp = &zp;
+        batch.size = 1;
+
+        PCHit result;
+        AssignPC(batch, &result, generator);
+        return result;
+    }
+
+    /*
+        Batched version of the cylinder intersection. Each chunk is done in two passes: a branch-free geometry pass over
+        contiguous arrays (misses flagged with wire ID -1), then a sequential pass drawing the z smearing for the hits.
+        A direction with no transverse component (theta = 0) never reaches the wires.
+    */
+    void PCDetector::AssignPC(const PCBatch& batch, PCHit* hits, std::mt19937_64& generator)
+    {
+        const WireTable& wires = GetWireTable();
+        int wireID[s_chunkSize];
+        double hitZ[s_chunkSize];
+
+        for(std::size_t start=0; start<batch.size; start += s_chunkSize)
+        {
+            const std::size_t n = std::min(s_chunkSize, batch.size - start);
+            const double* rxnX = batch.rxnX + start;
+            const double* rxnY = batch.rxnY + start;
+            const double* rxnZ = batch.rxnZ + start;
+            const double* dirX = batch.dirX + start;
+            const double* dirY = batch.dirY + start;
+            const double* dirZ = batch.dirZ + start;
+            const uint32_t* zp = batch.zp + start;
+
+            for(std::size_t i=0; i<n; i++)
+            {
+                double rxnRho = std::sqrt(rxnX[i]*rxnX[i] + rxnY[i]*rxnY[i]);
+                double trajRho = std::sqrt(dirX[i]*dirX[i] + dirY[i]*dirY[i]);
+                double b = 2.0 * (rxnX[i] * dirX[i] + rxnY[i] * dirY[i]);
+                double a = trajRho * trajRho;
+                double c = rxnRho * rxnRho - s_wireRadius * s_wireRadius;
+                double radicand = b*b - 4.0 * a * c;
+                double root = std::sqrt(std::max(radicand, 0.0));
+                double t1 = (-1.0*b + root)/(2.0 * a);
+                double t2 = (-1.0*b - root)/(2.0 * a);
+                double t = t1 < 0.0 ? t2 : t1;
+
+                double x = rxnX[i] + dirX[i]*t;
+                double y = rxnY[i] + dirY[i]*t;
+                double intersectPhi = (x == 0.0 && y == 0.0) ? 0.0 : std::atan2(y, x);
+                intersectPhi = intersectPhi < 0.0 ? intersectPhi + 2.0 * M_PI : intersectPhi;
+
+                bool isHit = a != 0.0 && rxnRho <= s_wireRadius && radicand >= 0.0 && (t1 >= 0.0 || t2 >= 0.0);
+                wireID[i] = isHit ? static_cast<int>(std::round(intersectPhi/s_wireDeltaPhi)) : -1;
+                hitZ[i] = rxnZ[i] + dirZ[i]*t;
+            }
+
+            for(std::size_t i=0; i<n; i++)
+            {
+                PCHit& result = hits[start + i];
+                result = PCHit();
+                if(wireID[i] == -1)
+                    continue;
+
+                result.wireID = wireID[i];
+                std::normal_distribution<double> smear(hitZ[i], zp[i] == 1 ? s_zSigmaProton : s_zSigmaNonProton);
+                result.hit = ROOT::Math::XYZPoint(wires.x[wireID[i]], wires.y[wireID[i]], smear(generator));
+            }
+        }
+    }
+
+    PCHit PCDetector::AssignPCReference(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, uint32_t zp, std::mt19937_64& generator)
     {
         PCHit result;
-        //ASIM_ASSERT(rxnPoint.Rho() < s_wireRadius, "Reaction did not occur within the PC");
         //Will neeeever intersect
         if(theta == 0.0 || rxnPoint.Rho() > s_wireRadius)
         {
@@ -75,7 +155,7 @@ namespace AnasenSim {
         double radicand = b*b - 4.0 * a * c;
         if(radicand < 0.0)
             return result;
-        
+
         double t1 = (-1.0*b + std::sqrt(radicand))/(2.0 * a);
         double t2 = (-1.0*b - std::sqrt(radicand))/(2.0 * a);
         ROOT::Math::XYZPoint intersectionPoint;
@@ -89,15 +169,29 @@ namespace AnasenSim {
         double intersectPhi = intersectionPoint.Phi();
         if(intersectPhi < 0.0)
             intersectPhi += 2.0 * M_PI;
-        
+
         double wireFrac = intersectPhi/s_wireDeltaPhi;
         result.wireID = std::round(wireFrac);
         double nearestWirePhi = result.wireID * s_wireDeltaPhi;
 
-        if(zp == 1)
-            result.hit = ROOT::Math::XYZPoint(s_wireRadius * std::cos(nearestWirePhi), s_wireRadius * std::sin(nearestWirePhi), RandomGenerator::GetNormal(intersectionPoint.Z(), s_zSigmaProton));
-        else
-            result.hit =  ROOT::Math::XYZPoint(s_wireRadius * std::cos(nearestWirePhi), s_wireRadius * std::sin(nearestWirePhi), RandomGenerator::GetNormal(intersectionPoint.Z(), s_zSigmaNonProton));
+        std::normal_distribution<double> smear(intersectionPoint.Z(), zp == 1 ? s_zSigmaProton : s_zSigmaNonProton);
+        result.hit = ROOT::Math::XYZPoint(s_wireRadius * std::cos(nearestWirePhi), s_wireRadius * std::sin(nearestWirePhi), smear(generator));
         return result;
     }
-}
\ No newline at end of file
+
+    PCDetector::WireTable::WireTable()
+    {
+        for(int i=0; i<=s_nWires; i++)
+        {
+            double wirePhi = i * s_wireDeltaPhi;
+            x[i] = s_wireRadius * std::cos(wirePhi);
+            y[i] = s_wireRadius * std::sin(wirePhi);
+        }
+    }
+
+    const PCDetector::WireTable& PCDetector::GetWireTable()
+    {
+        static const WireTable table;
+        return table;
+    }
+}
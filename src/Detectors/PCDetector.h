@@ -2,6 +2,9 @@
 #define PC_DETECTOR_H
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
 #include <vector>
 
 #include "Sim/RandomGenerator.h"
@@ -18,11 +21,30 @@ namespace AnasenSim {
         ROOT::Math::XYZPoint hit = {0., 0., 0.};
     };
 
+    //Structure-of-arrays input for batched PC assignment. Directions are unit vectors (sin(theta)cos(phi), sin(theta)sin(phi), cos(theta)).
+    struct PCBatch
+    {
+        const double* rxnX = nullptr;
+        const double* rxnY = nullptr;
+        const double* rxnZ = nullptr;
+        const double* dirX = nullptr;
+        const double* dirY = nullptr;
+        const double* dirZ = nullptr;
+        const uint32_t* zp = nullptr;
+        std::size_t size = 0;
+    };
+
     class PCDetector
     {
     public:
         static PCHit AssignPCOriginal(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, uint32_t zp);
-        static PCHit AssignPC(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, uint32_t zp);
+        //z smearing is drawn from generator, so independent generators make these safe to call from several threads
+        static PCHit AssignPC(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, uint32_t zp, std::mt19937_64& generator);
+        //Same result as AssignPC for every entry of the batch; hits must have room for batch.size entries
+        static void AssignPC(const PCBatch& batch, PCHit* hits, std::mt19937_64& generator);
+        //Scalar cylinder intersection the batched version was derived from, kept as the reference for DetectorValidation.
+        //Draws from generator in the same order as AssignPC, so equal seeds give equal results
+        static PCHit AssignPCReference(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, uint32_t zp, std::mt19937_64& generator);
 
     private:
         static constexpr int s_nWires = 24;
@@ -32,6 +54,17 @@ namespace AnasenSim {
         //Z-position uncertainty for protons and all others (2 cm for proton, 1cm for all else, here as sigma)
         static constexpr double s_zSigmaProton = 0.066666;
         static constexpr double s_zSigmaNonProton = 0.033333333;
+        static constexpr std::size_t s_chunkSize = 64; //Batch entries processed per pass
+
+        //Wire positions, indexed by wire ID
+        struct WireTable
+        {
+            WireTable();
+            double x[s_nWires + 1]; //Extra entry: intersections just below phi = 2pi round up to wire ID s_nWires
+            double y[s_nWires + 1];
+        };
+
+        static const WireTable& GetWireTable();
     };
 }
 
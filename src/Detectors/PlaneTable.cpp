@@ -0,0 +1,198 @@
+#include "PlaneTable.h"
+#include "IsEqual.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace AnasenSim {
+
+	PlaneTable::PlaneTable() :
+		m_nSX3{0, 0}, m_sx3Offset{0, 0}
+	{
+	}
+
+	PlaneTable::PlaneTable(const std::vector<SX3Detector>& barrel1, const std::vector<SX3Detector>& barrel2, const std::vector<QQQDetector>& qqq) :
+		m_nSX3{barrel1.size(), barrel2.size()}, m_sx3Offset{0, barrel1.size()}
+	{
+		if(barrel1.size() > s_maxSX3PerLayer || barrel2.size() > s_maxSX3PerLayer)
+		{
+			std::cerr << "Too many SX3 detectors in one barrel at PlaneTable::PlaneTable! Only the first " << s_maxSX3PerLayer << " are used." << std::endl;
+			m_nSX3[0] = std::min<std::size_t>(m_nSX3[0], s_maxSX3PerLayer);
+			m_nSX3[1] = std::min<std::size_t>(m_nSX3[1], s_maxSX3PerLayer);
+		}
+
+		for(const SX3Detector& sx3 : barrel1)
+			AddSX3(sx3);
+		for(const SX3Detector& sx3 : barrel2)
+			AddSX3(sx3);
+
+		//Extents are taken from the detector corners so boundaries compare exactly as in QQQDetector::GetTrajectoryRingWedge
+		for(const QQQDetector& detector : qqq)
+		{
+			m_qqqZ.push_back(detector.GetZ());
+			for(int r=0; r<s_nRings; r++)
+			{
+				m_ringRhoMin.push_back(detector.GetRingCoordinates(r, 1).Rho());
+				m_ringRhoMax.push_back(detector.GetRingCoordinates(r, 0).Rho());
+			}
+			for(int w=0; w<s_nWedges; w++)
+			{
+				m_wedgePhiMin.push_back(detector.GetWedgeCoordinates(w, 0).Phi());
+				m_wedgePhiMax.push_back(detector.GetWedgeCoordinates(w, 3).Phi());
+			}
+		}
+	}
+
+	PlaneTable::~PlaneTable() {}
+
+	void PlaneTable::AddSX3(const SX3Detector& sx3)
+	{
+		const ROOT::Math::XYZVector& normal = sx3.GetNormRotated();
+		const ROOT::Math::XYZPoint& origin = sx3.GetRotatedFrontStripCoordinates(0, 0);
+		m_normalX.push_back(normal.X());
+		m_normalY.push_back(normal.Y());
+		m_normalZ.push_back(normal.Z());
+		m_originX.push_back(origin.X());
+		m_originY.push_back(origin.Y());
+		m_originZ.push_back(origin.Z());
+		m_cosPhi.push_back(sx3.GetRotation().CosAngle());
+		m_sinPhi.push_back(sx3.GetRotation().SinAngle());
+		m_planeX.push_back(sx3.GetFrontStripCoordinates(0, 0).X());
+		m_centerZ.push_back(sx3.GetCenterZ());
+		m_halfLength.push_back(SX3Detector::GetLength() * 0.5);
+		m_frontZMin.push_back(sx3.GetFrontStripCoordinates(0, 1).Z());
+		m_frontZMax.push_back(sx3.GetFrontStripCoordinates(0, 0).Z());
+		m_backYMin.push_back(sx3.GetBackStripCoordinates(0, 1).Y());
+		m_backYMax.push_back(sx3.GetBackStripCoordinates(0, 2).Y());
+		for(int s=0; s<s_nStrips; s++)
+		{
+			m_frontYMin.push_back(sx3.GetFrontStripCoordinates(s, 1).Y());
+			m_frontYMax.push_back(sx3.GetFrontStripCoordinates(s, 2).Y());
+			m_backZMin.push_back(sx3.GetBackStripCoordinates(s, 1).Z());
+			m_backZMax.push_back(sx3.GetBackStripCoordinates(s, 0).Z());
+		}
+	}
+
+	void PlaneTable::IntersectSX3(Layer layer, const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, SX3Hit* hits) const
+	{
+		const std::size_t offset = m_sx3Offset[layer];
+		const std::size_t nPanels = m_nSX3[layer];
+		const double* normalX = m_normalX.data() + offset;
+		const double* normalY = m_normalY.data() + offset;
+		const double* normalZ = m_normalZ.data() + offset;
+		const double* originX = m_originX.data() + offset;
+		const double* originY = m_originY.data() + offset;
+		const double* originZ = m_originZ.data() + offset;
+		const double* cosPhi = m_cosPhi.data() + offset;
+		const double* sinPhi = m_sinPhi.data() + offset;
+
+		const double rx = rxnPoint.X(), ry = rxnPoint.Y(), rz = rxnPoint.Z();
+		const double dirX = std::sin(theta)*std::cos(phi);
+		const double dirY = std::sin(theta)*std::sin(phi);
+		const double dirZ = std::cos(theta);
+
+		//Plane intersection, then back to the panel frame with the inverse rotation. Branch free over all panels of the layer.
+		double localX[s_maxSX3PerLayer], localY[s_maxSX3PerLayer], localZ[s_maxSX3PerLayer];
+		for(std::size_t i=0; i<nPanels; i++)
+		{
+			double t = (normalX[i]*(originX[i] - rx) + normalY[i]*(originY[i] - ry) + normalZ[i]*(originZ[i] - rz)) /
+					   (normalX[i]*dirX + normalY[i]*dirY + normalZ[i]*dirZ);
+			double hitX = rx + dirX*t;
+			double hitY = ry + dirY*t;
+			double hitZ = rz + dirZ*t;
+			double inverseSin = -sinPhi[i];
+			localX[i] = cosPhi[i]*hitX - inverseSin*hitY;
+			localY[i] = inverseSin*hitX + cosPhi[i]*hitY;
+			localZ[i] = hitZ;
+		}
+
+		for(std::size_t i=0; i<nPanels; i++)
+		{
+			const std::size_t panel = offset + i;
+			const double x = localX[i], y = localY[i], z = localZ[i];
+			SX3Hit& hit = hits[i];
+			hit = SX3Hit();
+
+			if(Precision::IsFloatAlmostEqual(x, m_planeX[panel], s_epsilon) &&
+			   Precision::IsFloatGreaterOrAlmostEqual(z, m_frontZMin[panel], s_epsilon) &&
+			   Precision::IsFloatLessOrAlmostEqual(z, m_frontZMax[panel], s_epsilon))
+			{
+				for(int s=0; s<s_nStrips; s++)
+				{
+					if(Precision::IsFloatGreaterOrAlmostEqual(y, m_frontYMin[panel * s_nStrips + s], s_epsilon) &&
+					   Precision::IsFloatLessOrAlmostEqual(y, m_frontYMax[panel * s_nStrips + s], s_epsilon))
+					{
+						hit.front_strip_index = s;
+						hit.front_ratio = Precision::ClampFloat(-1.0, 1.0, (z - m_centerZ[panel])/m_halfLength[panel]);
+						break;
+					}
+				}
+			}
+
+			//Exact comparisons, as in SX3Detector::GetChannelRatio
+			if(x >= m_planeX[panel] && x <= m_planeX[panel] && y >= m_backYMin[panel] && y <= m_backYMax[panel])
+			{
+				for(int s=0; s<s_nStrips; s++)
+				{
+					if(z >= m_backZMin[panel * s_nStrips + s] && z <= m_backZMax[panel * s_nStrips + s])
+					{
+						hit.back_strip_index = s;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	void PlaneTable::IntersectQQQ(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, std::pair<int, int>* hits) const
+	{
+		const double tanTheta = std::tan(theta);
+		for(std::size_t i=0; i<m_qqqZ.size(); i++)
+		{
+			hits[i] = std::make_pair(-1, -1);
+			double rhoTraj = (m_qqqZ[i] - rxnPoint.Z())*tanTheta;
+			if(rhoTraj == 0.0)
+				rhoTraj = rxnPoint.Rho();
+
+			//Wedge acceptance does not depend on the ring, so the first matching ring and first matching wedge give the same pair
+			int wedge = -1;
+			for(int w=0; w<s_nWedges; w++)
+			{
+				if(Precision::IsFloatGreaterOrAlmostEqual(phi, m_wedgePhiMin[i * s_nWedges + w], s_epsilon) &&
+				   Precision::IsFloatLessOrAlmostEqual(phi, m_wedgePhiMax[i * s_nWedges + w], s_epsilon))
+				{
+					wedge = w;
+					break;
+				}
+			}
+			if(wedge == -1)
+				continue;
+
+			for(int r=0; r<s_nRings; r++)
+			{
+				if(Precision::IsFloatLessOrAlmostEqual(rhoTraj, m_ringRhoMax[i * s_nRings + r], s_epsilon) &&
+				   Precision::IsFloatGreaterOrAlmostEqual(rhoTraj, m_ringRhoMin[i * s_nRings + r], s_epsilon))
+				{
+					hits[i] = std::make_pair(r, wedge);
+					break;
+				}
+			}
+		}
+	}
+
+	void PlaneTable::IntersectSX3(Layer layer, const ROOT::Math::XYZPoint* rxnPoints, const double* theta, const double* phi,
+								  std::size_t nTrajectories, SX3Hit* hits) const
+	{
+		for(std::size_t i=0; i<nTrajectories; i++)
+			IntersectSX3(layer, rxnPoints[i], theta[i], phi[i], hits + i * m_nSX3[layer]);
+	}
+
+	void PlaneTable::IntersectQQQ(const ROOT::Math::XYZPoint* rxnPoints, const double* theta, const double* phi,
+								  std::size_t nTrajectories, std::pair<int, int>* hits) const
+	{
+		for(std::size_t i=0; i<nTrajectories; i++)
+			IntersectQQQ(rxnPoints[i], theta[i], phi[i], hits + i * m_qqqZ.size());
+	}
+
+}
@@ -0,0 +1,80 @@
+/*
+	PlaneTable.h
+	Flat (structure-of-arrays) table of the silicon detector planes, compiled once from the SX3Detector and QQQDetector
+	objects. Per SX3 panel it holds the plane normal, a point on the plane, the in-plane axes (rotation about z) and the
+	strip extents; per QQQ the plane z and the ring/wedge extents. Intersecting a trajectory with every panel of a layer
+	is then a loop over contiguous arrays, with no per-detector objects or rotation calls, which the compiler can vectorize.
+
+	Results are identical to SX3Detector::GetChannelRatio and QQQDetector::GetTrajectoryRingWedge: the same arithmetic is
+	done in the same order with the same boundary tolerances. The detector objects are still used for smeared hit positions.
+*/
+#ifndef PLANE_TABLE_H
+#define PLANE_TABLE_H
+
+#include <utility>
+#include <vector>
+
+#include "SX3Detector.h"
+#include "QQQDetector.h"
+
+namespace AnasenSim {
+
+	class PlaneTable
+	{
+	public:
+		enum Layer
+		{
+			Barrel1 = 0,
+			Barrel2 = 1
+		};
+
+		PlaneTable();
+		PlaneTable(const std::vector<SX3Detector>& barrel1, const std::vector<SX3Detector>& barrel2, const std::vector<QQQDetector>& qqq);
+		~PlaneTable();
+
+		//One result per detector of the layer, in detector order
+		void IntersectSX3(Layer layer, const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, SX3Hit* hits) const;
+		void IntersectQQQ(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi, std::pair<int, int>* hits) const;
+
+		//Many trajectories at once. Results are laid out [trajectory][detector]
+		void IntersectSX3(Layer layer, const ROOT::Math::XYZPoint* rxnPoints, const double* theta, const double* phi,
+						  std::size_t nTrajectories, SX3Hit* hits) const;
+		void IntersectQQQ(const ROOT::Math::XYZPoint* rxnPoints, const double* theta, const double* phi,
+						  std::size_t nTrajectories, std::pair<int, int>* hits) const;
+
+		std::size_t GetNumberOfSX3(Layer layer) const { return m_nSX3[layer]; }
+		std::size_t GetNumberOfQQQ() const { return m_qqqZ.size(); }
+
+	private:
+		void AddSX3(const SX3Detector& sx3);
+
+		static constexpr double s_epsilon = 1.0e-6; //Same tolerance as the detector classes
+		static constexpr int s_nStrips = SX3Detector::GetNumberOfStrips();
+		static constexpr int s_nRings = QQQDetector::GetNumberOfRings();
+		static constexpr int s_nWedges = QQQDetector::GetNumberOfWedges();
+		static constexpr int s_maxSX3PerLayer = 32;
+
+		std::size_t m_nSX3[2];
+		std::size_t m_sx3Offset[2];
+
+		//Per SX3 panel
+		std::vector<double> m_normalX, m_normalY, m_normalZ;
+		std::vector<double> m_originX, m_originY, m_originZ; //Top-left corner of front strip 0
+		std::vector<double> m_cosPhi, m_sinPhi; //Rotation about z from the panel frame to the lab frame
+		std::vector<double> m_planeX; //Panel-frame x of the plane
+		std::vector<double> m_centerZ;
+		std::vector<double> m_halfLength;
+		std::vector<double> m_frontZMin, m_frontZMax;
+		std::vector<double> m_backYMin, m_backYMax;
+		std::vector<double> m_frontYMin, m_frontYMax; //[panel * s_nStrips + strip]
+		std::vector<double> m_backZMin, m_backZMax; //[panel * s_nStrips + strip]
+
+		//Per QQQ
+		std::vector<double> m_qqqZ;
+		std::vector<double> m_ringRhoMin, m_ringRhoMax; //[detector * s_nRings + ring]
+		std::vector<double> m_wedgePhiMin, m_wedgePhiMax; //[detector * s_nWedges + wedge]
+	};
+
+}
+
+#endif
@@ -3,7 +3,7 @@
 namespace AnasenSim {
 
 	QQQDetector::QQQDetector(double phiCentral, double zOffset, double xOffset, double yOffset) :
-		m_centralPhi(phiCentral), m_translation(xOffset,yOffset,zOffset), m_norm(0.0,0.0,1.0), m_isSmearing(false)
+		m_centralPhi(phiCentral), m_translation(xOffset,yOffset,zOffset), m_norm(0.0,0.0,1.0)
 	{
 		m_zRotation.SetAngle(m_centralPhi);
 		m_ringCoords.resize(s_nRings);
@@ -86,7 +86,7 @@ namespace AnasenSim {
 
 	}
 
-	ROOT::Math::XYZPoint QQQDetector::GetTrajectoryCoordinates(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi)
+	ROOT::Math::XYZPoint QQQDetector::GetTrajectoryCoordinates(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi) const
 	{
 		double z_to_detector = m_translation.Vect().Z() - rxnPoint.Z();
 		double rho_traj = z_to_detector*std::tan(theta);
@@ -104,7 +104,7 @@ namespace AnasenSim {
 			if(Precision::IsFloatLessOrAlmostEqual(rho_traj, max_rho, s_epsilon) &&
 			   Precision::IsFloatGreaterOrAlmostEqual(rho_traj, min_rho, s_epsilon))
 			{
-				for(auto& wedge : m_wedgeCoords)
+				for(const auto& wedge : m_wedgeCoords)
 				{
 					min_phi = wedge[0].Phi();
 					max_phi = wedge[3].Phi();
@@ -123,7 +123,7 @@ namespace AnasenSim {
 		return result;
 	}
 
-	std::pair<int,int> QQQDetector::GetTrajectoryRingWedge(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi)
+	std::pair<int,int> QQQDetector::GetTrajectoryRingWedge(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi) const
 	{
 		double z_to_detector = m_translation.Vect().Z() - rxnPoint.Z();
 		double rho_traj = z_to_detector*std::tan(theta);
@@ -134,7 +134,7 @@ namespace AnasenSim {
 
 		for(int r=0; r<s_nRings; r++)
 		{
-			auto& ring = m_ringCoords[r];
+			const auto& ring = m_ringCoords[r];
 			min_rho = ring[1].Rho();
 			max_rho = ring[0].Rho();
 			if(Precision::IsFloatLessOrAlmostEqual(rho_traj, max_rho, s_epsilon) &&
@@ -142,7 +142,7 @@ namespace AnasenSim {
 			{
 				for(int w=0; w<s_nWedges; w++)
 				{
-					auto& wedge = m_wedgeCoords[w];
+					const auto& wedge = m_wedgeCoords[w];
 					min_phi = wedge[0].Phi();
 					max_phi = wedge[3].Phi();
 					if(Precision::IsFloatGreaterOrAlmostEqual(phi, min_phi, s_epsilon) && 
@@ -155,22 +155,18 @@ namespace AnasenSim {
 		return std::make_pair(-1, -1);
 	}
 
-	ROOT::Math::XYZPoint QQQDetector::GetHitCoordinates(int ringch, int wedgech)
+	ROOT::Math::XYZPoint QQQDetector::GetHitCoordinates(int ringch, int wedgech) const
+	{
+		return GetHitCoordinates(ringch, wedgech, 0.5, 0.5);
+	}
+
+	ROOT::Math::XYZPoint QQQDetector::GetHitCoordinates(int ringch, int wedgech, double ringFraction, double wedgeFraction) const
 	{
 		if(!CheckChannel(ringch) || !CheckChannel(wedgech))
 			return ROOT::Math::XYZPoint();
 
-		double r_center, phi_center;
-		if(m_isSmearing)
-		{
-			r_center  = s_innerR + (RandomGenerator::GetUniformFraction()+ringch)*s_deltaR;
-			phi_center = -s_deltaPhiTotal/2.0 + (RandomGenerator::GetUniformFraction()+wedgech)*s_deltaPhi;
-		}
-		else
-		{
-			r_center  = s_innerR + (0.5+ringch)*s_deltaR;
-			phi_center = -s_deltaPhiTotal/2.0 + (0.5+wedgech)*s_deltaPhi;
-		}
+		double r_center  = s_innerR + (ringFraction+ringch)*s_deltaR;
+		double phi_center = -s_deltaPhiTotal/2.0 + (wedgeFraction+wedgech)*s_deltaPhi;
 		double x = r_center*std::cos(phi_center);
 		double y = r_center*std::sin(phi_center);
 		double z = 0;
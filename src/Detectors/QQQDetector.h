@@ -11,7 +11,6 @@
 #include <cmath>
 #include <vector>
 
-#include "Sim/RandomGenerator.h"
 #include "Math/Point3D.h"
 #include "Math/Vector3D.h"
 #include "Math/RotationZ.h"
@@ -24,25 +23,27 @@ namespace AnasenSim {
 	public:
 		QQQDetector(double phiCentral, double zOffset, double xOffset=0, double yOffset=0);
 		~QQQDetector();
-		const ROOT::Math::XYZPoint& GetRingCoordinates(int ringch, int corner) { return m_ringCoords[ringch][corner]; }
-		const ROOT::Math::XYZPoint& GetWedgeCoordinates(int wedgech, int corner) { return m_wedgeCoords[wedgech][corner]; }
-		const ROOT::Math::XYZVector& GetNorm() { return m_norm; }
-		ROOT::Math::XYZPoint GetTrajectoryCoordinates(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi);
-		std::pair<int, int> GetTrajectoryRingWedge(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi);
-		ROOT::Math::XYZPoint GetHitCoordinates(int ringch, int wedgech);
+		const ROOT::Math::XYZPoint& GetRingCoordinates(int ringch, int corner) const { return m_ringCoords[ringch][corner]; }
+		const ROOT::Math::XYZPoint& GetWedgeCoordinates(int wedgech, int corner) const { return m_wedgeCoords[wedgech][corner]; }
+		const ROOT::Math::XYZVector& GetNorm() const { return m_norm; }
+		double GetZ() const { return m_translation.Vect().Z(); }
+		ROOT::Math::XYZPoint GetTrajectoryCoordinates(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi) const;
+		std::pair<int, int> GetTrajectoryRingWedge(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi) const;
+		//Hit at the center of the pixel
+		ROOT::Math::XYZPoint GetHitCoordinates(int ringch, int wedgech) const;
+		//Hit smeared across the pixel; fractions are uniform random numbers in [0, 1)
+		ROOT::Math::XYZPoint GetHitCoordinates(int ringch, int wedgech, double ringFraction, double wedgeFraction) const;
 
-		void SetSmearing(bool isSmearing) { m_isSmearing = isSmearing; }
-
-		int GetNumberOfRings() { return s_nRings; }
-		int GetNumberOfWedges() { return s_nWedges; }
+		static constexpr int GetNumberOfRings() { return s_nRings; }
+		static constexpr int GetNumberOfWedges() { return s_nWedges; }
 
 	private:
 
-		bool CheckChannel(int ch) { return (ch >=0 && ch < s_nRings); }
-		bool CheckCorner(int corner) { return (corner >=0 && corner < 4); }
+		bool CheckChannel(int ch) const { return (ch >=0 && ch < s_nRings); }
+		bool CheckCorner(int corner) const { return (corner >=0 && corner < 4); }
 
 		void CalculateCorners();
-		ROOT::Math::XYZPoint TransformCoordinates(ROOT::Math::XYZPoint& vector) { return m_translation * (m_zRotation * vector) ; }
+		ROOT::Math::XYZPoint TransformCoordinates(const ROOT::Math::XYZPoint& vector) const { return m_translation * (m_zRotation * vector) ; }
 
 		double m_centralPhi;
 
@@ -51,8 +52,6 @@ namespace AnasenSim {
 		ROOT::Math::XYZVector m_norm;
 		ROOT::Math::RotationZ m_zRotation;
 
-		bool m_isSmearing;
-
 		static constexpr double s_epsilon = 1.0e-6; //accuracy
 		static constexpr int s_nRings = 16;
 		static constexpr int s_nWedges = 16;
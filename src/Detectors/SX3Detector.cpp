@@ -18,9 +18,10 @@
 namespace AnasenSim {
 
 	SX3Detector::SX3Detector(double centerPhi, double centerZ, double centerRho) :
-		m_centerPhi(centerPhi), m_centerZ(centerZ), m_centerRho(centerRho), m_norm(1.0,0.0,0.0), m_isSmearing(false)
+		m_centerPhi(centerPhi), m_centerZ(centerZ), m_centerRho(centerRho), m_norm(1.0,0.0,0.0)
 	{
 		m_zRotation.SetAngle(m_centerPhi);
+		m_rotNorm = m_zRotation * m_norm;
 
 		m_frontStripCoords.resize(s_nStrips);
 		m_backStripCoords.resize(s_nStrips);
@@ -77,17 +78,18 @@ namespace AnasenSim {
 		}
 	}
 
-	ROOT::Math::XYZPoint SX3Detector::GetHitCoordinates(int front_stripch, double front_strip_ratio)
+	ROOT::Math::XYZPoint SX3Detector::GetHitCoordinates(int front_stripch, double front_strip_ratio) const
+	{
+		return GetHitCoordinates(front_stripch, front_strip_ratio, 0.5);
+	}
+
+	ROOT::Math::XYZPoint SX3Detector::GetHitCoordinates(int front_stripch, double front_strip_ratio, double stripFraction) const
 	{
 
 		if (!ValidChannel(front_stripch) || !ValidRatio(front_strip_ratio))
 			return ROOT::Math::XYZPoint(0,0,0);
 
-		double y;
-		if(m_isSmearing)
-			y = s_totalWidth/2.0 - (front_stripch + RandomGenerator::GetUniformFraction())*s_frontStripWidth;
-		else
-			y = s_totalWidth/2.0 - (front_stripch+0.5)*s_frontStripWidth;
+		double y = s_totalWidth/2.0 - (front_stripch + stripFraction)*s_frontStripWidth;
 
 		//recall we're still assuming phi=0 det:
 		ROOT::Math::XYZPoint coords(m_centerRho, y, front_strip_ratio*(s_totalLength*0.5) + m_centerZ);
@@ -98,9 +100,9 @@ namespace AnasenSim {
 	}
 
 	//Modified for gas target
-	SX3Hit SX3Detector::GetChannelRatio(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi)
+	SX3Hit SX3Detector::GetChannelRatio(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi) const
 	{														
-		ROOT::Math::XYZPoint& corner = m_rotFrontStripCoords[0][0]; //Top left
+		const ROOT::Math::XYZPoint& corner = m_rotFrontStripCoords[0][0]; //Top left
 		
 		//Plane normal in rotated frame
 		ROOT::Math::XYZVector normPlane = GetNormRotated();
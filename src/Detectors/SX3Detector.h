@@ -17,7 +17,6 @@
 #include "Math/Point3D.h"
 #include "Math/Vector3D.h"
 #include "Math/RotationZ.h"
-#include "Sim/RandomGenerator.h"
 #include "IsEqual.h"
 
 namespace AnasenSim {
@@ -45,16 +44,22 @@ namespace AnasenSim {
 		{ 
 			return m_rotBackStripCoords[stripch][corner];
 		}
-		ROOT::Math::XYZVector GetNormRotated() const { return m_zRotation * m_norm; }
-
-		void SetPixelSmearing(bool isSmearing) { m_isSmearing = isSmearing; }
-
-		ROOT::Math::XYZPoint GetHitCoordinates(int front_stripch, double front_strip_ratio);
-		SX3Hit GetChannelRatio(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi);
+		const ROOT::Math::XYZVector& GetNormRotated() const { return m_rotNorm; }
+		const ROOT::Math::RotationZ& GetRotation() const { return m_zRotation; }
+		double GetCenterZ() const { return m_centerZ; }
+		double GetCenterRho() const { return m_centerRho; }
+		static constexpr int GetNumberOfStrips() { return s_nStrips; }
+		static constexpr double GetLength() { return s_totalLength; }
+
+		//Hit at the center of the front strip
+		ROOT::Math::XYZPoint GetHitCoordinates(int front_stripch, double front_strip_ratio) const;
+		//Hit smeared across the front strip width; stripFraction is a uniform random number in [0, 1)
+		ROOT::Math::XYZPoint GetHitCoordinates(int front_stripch, double front_strip_ratio, double stripFraction) const;
+		SX3Hit GetChannelRatio(const ROOT::Math::XYZPoint& rxnPoint, double theta, double phi) const;
 
 	private:
-		bool ValidChannel(int f) { return ((f >= 0 && f < s_nStrips) ? true : false); };
-		bool ValidRatio(double r) { return ((Precision::IsFloatGreaterOrAlmostEqual(r, -1.0, s_epsilon) &&
+		bool ValidChannel(int f) const { return ((f >= 0 && f < s_nStrips) ? true : false); };
+		bool ValidRatio(double r) const { return ((Precision::IsFloatGreaterOrAlmostEqual(r, -1.0, s_epsilon) &&
 											 Precision::IsFloatLessOrAlmostEqual(r,  1.0, s_epsilon) ? true : false)); };
 		void CalculateCorners();
 
@@ -66,11 +71,10 @@ namespace AnasenSim {
 		std::vector<std::vector<ROOT::Math::XYZPoint>> m_rotFrontStripCoords, m_rotBackStripCoords;
 
 		ROOT::Math::XYZVector m_norm;
+		ROOT::Math::XYZVector m_rotNorm;
 
 		ROOT::Math::RotationZ m_zRotation;
 
-		bool m_isSmearing;
-
 		//Units in meters
 		static constexpr double s_epsilon = 1.0e-6; //accuracy
 		static constexpr double s_nStrips = 4; //Same for front and back
@@ -4,6 +4,9 @@
 	additional properties of the number of total nucleons (A), the number of protons (Z), a ground state mass,
 	an exctitation energy, and an isotopic symbol.
 
+	This is the persisted (ROOT dictionary) form. Generation and detection work on the plain NucleusRecord
+	(Sim/NucleusRecord.h), which is converted to Nucleus when an event is written.
+
 	--GWM Jan 2021
 */
 #ifndef NUCLEUS_H
@@ -56,6 +59,7 @@ namespace AnasenSim {
 		ROOT::Math::PxPyPzEVector vec4;
 		ROOT::Math::XYZPoint rxnPoint;
 		ReactionRole role = ReactionRole::None;
+		uint32_t step = 0; //Step of the chain that produced the nucleus; the first step's target and projectile are 0
 
 		bool isDetected = false;
 		double siliconDetKE = 0.0; //MeV
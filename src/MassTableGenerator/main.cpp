@@ -0,0 +1,125 @@
+/*
+	MassTableGenerator
+	Writes MassTable.h, the isotopic masses compiled into AnasenSim, from an AME mass file (the format of etc/mass.txt).
+	The file is read with ReadMassFile, the parser MassLookup::LoadFile uses, and laid out as LoadFile lays it out: ordered
+	by Z then A, with a placeholder for each isotope of an element's range that is missing from the file. The file's values
+	are copied verbatim into constexpr calls of MassLookup::GetIsotopicMass, so the compiled-in masses are exactly those
+	LoadFile computes from the same file.
+
+	Usage: MassTableGenerator <mass_file> <output_header>. Run by the build whenever etc/mass.txt changes.
+*/
+#include "Sim/MassFile.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+	struct Range
+	{
+		uint32_t offset = 0;
+		uint32_t aMin = 1;
+		uint32_t aMax = 0; //aMin > aMax for an element with no isotopes
+	};
+
+	std::string StripLeadingZeros(const std::string& value)
+	{
+		std::size_t first = value.find_first_not_of('0');
+		if(first == std::string::npos || value[first] == '.')
+			return "0" + value.substr(first == std::string::npos ? value.size() : first);
+		return value.substr(first);
+	}
+
+}
+
+int main(int argc, char** argv)
+{
+	if(argc != 3)
+	{
+		std::cerr << "MassTableGenerator requires an input mass file and an output header!" << std::endl;
+		return 1;
+	}
+
+	std::vector<AnasenSim::MassFileEntry> entries;
+	if(!AnasenSim::ReadMassFile(argv[1], entries))
+		return 1;
+
+	std::map<std::pair<uint32_t, uint32_t>, const AnasenSim::MassFileEntry*> isotopes;
+	for(const AnasenSim::MassFileEntry& entry : entries)
+		isotopes[{entry.Z, entry.A}] = &entry;
+
+	std::vector<Range> ranges(isotopes.rbegin()->first.first + 1);
+	for(const auto& isotope : isotopes)
+	{
+		Range& range = ranges[isotope.first.first];
+		if(range.aMin > range.aMax)
+			range.aMin = isotope.first.second;
+		range.aMax = isotope.first.second;
+	}
+	uint32_t offset = 0;
+	for(Range& range : ranges)
+	{
+		range.offset = offset;
+		if(range.aMax >= range.aMin)
+			offset += range.aMax - range.aMin + 1;
+	}
+
+	std::ofstream output(argv[2]);
+	if(!output.is_open())
+	{
+		std::cerr << "Unable to open output header " << argv[2] << " at MassTableGenerator!" << std::endl;
+		return 1;
+	}
+
+	output << "/*\n"
+		   << "\tMassTable.h\n"
+		   << "\tIsotopic masses compiled into the simulation, generated from the AME atomic mass evaluation in etc/mass.txt (same format,\n"
+		   << "\twhich is also the format of a MassFile override). Entries are ordered by Z then A with no holes: isotopes missing from the\n"
+		   << "\tevaluation are placeholders with no symbol, so the entry for (Z, A) is s_massTable[s_elementRanges[Z].offset + A - aMin].\n"
+		   << "\tMasses are computed at compile time exactly as MassLookup::LoadFile computes them from the file.\n"
+		   << "\n"
+		   << "\tWritten by MassTableGenerator at build time; do not edit. Included only by MassLookup.cpp.\n"
+		   << "*/\n"
+		   << "#ifndef MASS_TABLE_H\n"
+		   << "#define MASS_TABLE_H\n"
+		   << "\n"
+		   << "#include \"Sim/MassLookup.h\"\n"
+		   << "\n"
+		   << "namespace AnasenSim {\n"
+		   << "\n"
+		   << "\t//Indexed by Z\n"
+		   << "\tstatic constexpr MassLookup::ElementRange s_elementRanges[] =\n"
+		   << "\t{\n";
+	for(uint32_t i=0; i<ranges.size(); i++)
+		output << "\t\t{" << ranges[i].offset << ", " << ranges[i].aMin << ", " << ranges[i].aMax << "}, //Z = " << i << "\n";
+	output << "\t};\n"
+		   << "\n"
+		   << "\tstatic constexpr MassLookup::NucData s_massTable[] =\n"
+		   << "\t{\n";
+	for(uint32_t i=0; i<ranges.size(); i++)
+	{
+		for(uint32_t j=ranges[i].aMin; j<=ranges[i].aMax; j++)
+		{
+			auto iter = isotopes.find({i, j});
+			if(iter == isotopes.end())
+				output << "\t\t{nullptr, MassLookup::s_invalidMass, " << i << ", " << j << "}, //not in table\n";
+			else
+			{
+				const AnasenSim::MassFileEntry& entry = *(iter->second);
+				output << "\t\t{\"" << entry.A << entry.element << "\", MassLookup::GetIsotopicMass(" << i << ", " << entry.atomicMassU
+					   << ".0, " << StripLeadingZeros(entry.atomicMassMicroU) << "), " << i << ", " << j << "},\n";
+			}
+		}
+	}
+	output << "\t};\n"
+		   << "\n"
+		   << "}\n"
+		   << "\n"
+		   << "#endif\n";
+
+	return 0;
+}
@@ -24,56 +24,39 @@ namespace AnasenSim {
 
     Plotter::~Plotter() {}
 
-    void Plotter::FillHistogram1D(const Histogram1DParams& params, double value)
+    TH1* Plotter::GetHistogram1D(const Histogram1DParams& params)
     {
         auto iter = m_map.find(params.name);
-        if(iter == m_map.end())
-        {
-            std::shared_ptr<TH1F> histo = std::make_shared<TH1F>(params.name.c_str(), params.title.c_str(), params.bins, params.min, params.max);
-            m_map[params.name] = std::static_pointer_cast<TObject>(histo);
-            histo->Fill(value);
-        }
-        else
-        {
-            auto histo = std::static_pointer_cast<TH1>(iter->second);
-            if(histo)
-                histo->Fill(value);
-        }
+        if(iter != m_map.end())
+            return std::static_pointer_cast<TH1>(iter->second).get();
+
+        std::shared_ptr<TH1F> histo = std::make_shared<TH1F>(params.name.c_str(), params.title.c_str(), params.bins, params.min, params.max);
+        m_map[params.name] = std::static_pointer_cast<TObject>(histo);
+        return histo.get();
     }
 
-    void Plotter::FillHistogram2D(const Histogram2DParams& params, double valueX, double valueY)
+    TH2* Plotter::GetHistogram2D(const Histogram2DParams& params)
     {
         auto iter = m_map.find(params.name);
-        if(iter == m_map.end())
-        {
-            std::shared_ptr<TH2F> histo = std::make_shared<TH2F>(params.name.c_str(), params.title.c_str(), params.binsX, params.minX, params.maxX, params.binsY, params.minY, params.maxY);
-            m_map[params.name] = std::static_pointer_cast<TObject>(histo);
-            histo->Fill(valueX, valueY);
-        }
-        else
-        {
-            auto histo = std::static_pointer_cast<TH2>(iter->second);
-            if(histo)
-                histo->Fill(valueX, valueY);
-        }
+        if(iter != m_map.end())
+            return std::static_pointer_cast<TH2>(iter->second).get();
+
+        std::shared_ptr<TH2F> histo = std::make_shared<TH2F>(params.name.c_str(), params.title.c_str(), params.binsX, params.minX, params.maxX, params.binsY, params.minY, params.maxY);
+        m_map[params.name] = std::static_pointer_cast<TObject>(histo);
+        return histo.get();
     }
 
-    void Plotter::FillGraph(const GraphParams& params, double valueX, double valueY)
+    TGraph* Plotter::GetGraph(const GraphParams& params)
     {
         auto iter = m_map.find(params.name);
-        if(iter == m_map.end())
-        {
-            std::shared_ptr<TGraph> graph = std::make_shared<TGraph>(1, &valueX, &valueY);
-            graph->SetName(params.name.c_str());
-            graph->SetTitle(params.title.c_str());
-            m_map[params.name] = std::static_pointer_cast<TObject>(graph);
-        }
-        else
-        {
-            auto graph = std::static_pointer_cast<TGraph>(iter->second);
-            if(graph)
-                graph->AddPoint(valueX, valueY);
-        }
+        if(iter != m_map.end())
+            return std::static_pointer_cast<TGraph>(iter->second).get();
+
+        std::shared_ptr<TGraph> graph = std::make_shared<TGraph>();
+        graph->SetName(params.name.c_str());
+        graph->SetTitle(params.title.c_str());
+        m_map[params.name] = std::static_pointer_cast<TObject>(graph);
+        return graph.get();
     }
 
     void Plotter::Run()
@@ -146,22 +129,56 @@ namespace AnasenSim {
         std::cout << std::endl << "Complete." << std::endl;
     }
 
-    void Plotter::PlotNucleus(const Nucleus& nucleus)
+    //Names are built only the first time a species/role/step is seen; later nuclei fill the cached plots directly.
+    //Every decay step reuses the Breakup roles, so nuclei from steps after the first are told apart by a _step<i> suffix
+    NucleusPlots& Plotter::GetNucleusPlots(const Nucleus& nucleus)
     {
+        uint64_t key = (uint64_t(nucleus.Z) << 40) | (uint64_t(nucleus.A) << 16) | (uint64_t(uint8_t(nucleus.step)) << 8) | uint64_t(uint8_t(nucleus.role));
+        auto iter = m_nucleusPlots.find(key);
+        if(iter != m_nucleusPlots.end())
+            return iter->second;
+
         std::stringstream nucleusStream;
         nucleusStream << nucleus.isotopicSymbol << "_" << ReactionRoleToString(nucleus.role);
-        FillGraph({nucleusStream.str() + "_KE_theta", nucleusStream.str() + ";#theta_{lab};KE (MeV)"}, nucleus.vec4.Theta() * s_rad2deg, nucleus.GetKE());
-        FillGraph({nucleusStream.str() + "_KE_phi", nucleusStream.str() + ";#phi_{lab};KE (MeV)"}, FullPhi(nucleus.vec4.Phi()) * s_rad2deg, nucleus.GetKE());
-        FillGraph({nucleusStream.str() + "_rxnX_rxnY", nucleusStream.str() + ";rxnX (m);rxnY (m)"}, nucleus.rxnPoint.X(), nucleus.rxnPoint.Y());
-        FillHistogram1D({nucleusStream.str() + "_rxnZ", nucleusStream.str() + ";rxnZ (m);", 554, 0.0, 0.554}, nucleus.rxnPoint.Z());
+        if(nucleus.step != 0)
+            nucleusStream << "_step" << nucleus.step;
+        NucleusPlots& plots = m_nucleusPlots[key];
+        plots.name = nucleusStream.str();
+        plots.keTheta = GetGraph({plots.name + "_KE_theta", plots.name + ";#theta_{lab};KE (MeV)"});
+        plots.kePhi = GetGraph({plots.name + "_KE_phi", plots.name + ";#phi_{lab};KE (MeV)"});
+        plots.rxnXY = GetGraph({plots.name + "_rxnX_rxnY", plots.name + ";rxnX (m);rxnY (m)"});
+        plots.rxnZ = GetHistogram1D({plots.name + "_rxnZ", plots.name + ";rxnZ (m);", 554, 0.0, 0.554});
+        return plots;
+    }
+
+    void Plotter::InitDetectedPlots(NucleusPlots& plots)
+    {
+        plots.keThetaDetected = GetGraph({plots.name + "_KE_theta_det", plots.name + ";#theta_{lab};KE (MeV)"});
+        plots.kePhiDetected = GetGraph({plots.name + "_KE_phi_det", plots.name + ";#phi_{lab};KE (MeV)"});
+        plots.rxnXYDetected = GetGraph({plots.name + "_rxnX_rxnY_det", plots.name + ";rxnX (m);rxnY (m)"});
+        plots.edeDetected = GetHistogram2D({plots.name + "_EdE_pcE_siKE", plots.name + "_EdE;Si KE(MeV);PC E(MeV)", 200, 0.0, 35.0, 200, 0.0, 20.0});
+        plots.rxnZDetected = GetHistogram1D({plots.name + "_rxnZ_det", plots.name + ";rxnZ (m);", 554, 0.0, 0.554});
+        if(m_edeHistogram == nullptr)
+            m_edeHistogram = GetHistogram2D({"EdE_pcE_siKE", "EdE;Si KE(MeV);PC E(MeV)", 3500, 0.0, 35.0, 1500, 0.0, 15.0});
+    }
+
+    void Plotter::PlotNucleus(const Nucleus& nucleus)
+    {
+        NucleusPlots& plots = GetNucleusPlots(nucleus);
+        plots.keTheta->AddPoint(nucleus.vec4.Theta() * s_rad2deg, nucleus.GetKE());
+        plots.kePhi->AddPoint(FullPhi(nucleus.vec4.Phi()) * s_rad2deg, nucleus.GetKE());
+        plots.rxnXY->AddPoint(nucleus.rxnPoint.X(), nucleus.rxnPoint.Y());
+        plots.rxnZ->Fill(nucleus.rxnPoint.Z());
         if(nucleus.isDetected)
         {
-            FillGraph({nucleusStream.str() + "_KE_theta_det", nucleusStream.str() + ";#theta_{lab};KE (MeV)"}, nucleus.vec4.Theta() * s_rad2deg, nucleus.siliconDetKE);
-            FillGraph({nucleusStream.str() + "_KE_phi_det", nucleusStream.str() + ";#phi_{lab};KE (MeV)"}, FullPhi(nucleus.vec4.Phi()) * s_rad2deg, nucleus.siliconDetKE);
-            FillGraph({nucleusStream.str() + "_rxnX_rxnY_det", nucleusStream.str() + ";rxnX (m);rxnY (m)"}, nucleus.rxnPoint.X(), nucleus.rxnPoint.Y());
-            FillHistogram2D({"EdE_pcE_siKE", "EdE;Si KE(MeV);PC E(MeV)", 3500, 0.0, 35.0, 1500, 0.0, 15.0}, nucleus.siliconDetKE, nucleus.pcDetE);
-            FillHistogram2D({nucleusStream.str() + "_EdE_pcE_siKE", nucleusStream.str() + "_EdE;Si KE(MeV);PC E(MeV)", 200, 0.0, 35.0, 200, 0.0, 20.0}, nucleus.siliconDetKE, nucleus.pcDetE);
-            FillHistogram1D({nucleusStream.str() + "_rxnZ_det", nucleusStream.str() + ";rxnZ (m);", 554, 0.0, 0.554}, nucleus.rxnPoint.Z());
+            if(plots.keThetaDetected == nullptr)
+                InitDetectedPlots(plots);
+            plots.keThetaDetected->AddPoint(nucleus.vec4.Theta() * s_rad2deg, nucleus.siliconDetKE);
+            plots.kePhiDetected->AddPoint(FullPhi(nucleus.vec4.Phi()) * s_rad2deg, nucleus.siliconDetKE);
+            plots.rxnXYDetected->AddPoint(nucleus.rxnPoint.X(), nucleus.rxnPoint.Y());
+            m_edeHistogram->Fill(nucleus.siliconDetKE, nucleus.pcDetE);
+            plots.edeDetected->Fill(nucleus.siliconDetKE, nucleus.pcDetE);
+            plots.rxnZDetected->Fill(nucleus.rxnPoint.Z());
         }
     }
 }
\ No newline at end of file
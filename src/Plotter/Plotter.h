@@ -8,6 +8,9 @@
 #include <unordered_map>
 
 class TObject;
+class TH1;
+class TH2;
+class TGraph;
 
 namespace AnasenSim {
 
@@ -54,6 +57,22 @@ namespace AnasenSim {
         std::string title = "";
     };
 
+    //Plots filled for each species/role/step, looked up once per nucleus instead of by name for every fill.
+    //Detected plots are only created once a nucleus of that species/role/step is detected
+    struct NucleusPlots
+    {
+        std::string name = "";
+        TGraph* keTheta = nullptr;
+        TGraph* kePhi = nullptr;
+        TGraph* rxnXY = nullptr;
+        TH1* rxnZ = nullptr;
+        TGraph* keThetaDetected = nullptr;
+        TGraph* kePhiDetected = nullptr;
+        TGraph* rxnXYDetected = nullptr;
+        TH2* edeDetected = nullptr;
+        TH1* rxnZDetected = nullptr;
+    };
+
     class Plotter
     {
     public:
@@ -64,15 +83,19 @@ namespace AnasenSim {
 
     private:
         void PlotNucleus(const Nucleus& nucleus);
+        NucleusPlots& GetNucleusPlots(const Nucleus& nucleus);
+        void InitDetectedPlots(NucleusPlots& plots);
 
-        void FillHistogram1D(const Histogram1DParams& params, double value);
-        void FillHistogram2D(const Histogram2DParams& params, double valueX, double valueY);
-        void FillGraph(const GraphParams& params, double valueX, double valueY);
+        TH1* GetHistogram1D(const Histogram1DParams& params);
+        TH2* GetHistogram2D(const Histogram2DParams& params);
+        TGraph* GetGraph(const GraphParams& params);
 
         std::string m_inputName;
         std::string m_outputName;
 
         std::unordered_map<std::string, std::shared_ptr<TObject>> m_map;
+        std::unordered_map<uint64_t, NucleusPlots> m_nucleusPlots; //Keyed by Z, A, step and role
+        TH2* m_edeHistogram = nullptr; //All detected species
 
         static constexpr double s_rad2deg = 180.0/M_PI;
     };
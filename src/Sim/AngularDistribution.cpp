@@ -0,0 +1,139 @@
+#include "AngularDistribution.h"
+#include "RandomGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+namespace AnasenSim {
+
+	AngularDistribution::AngularDistribution() {}
+
+	AngularDistribution::~AngularDistribution() {}
+
+	bool AngularDistribution::ReadFile(const std::string& filename)
+	{
+		m_bins.clear();
+		std::ifstream input(filename);
+		if(!input.is_open())
+		{
+			std::cerr << "Unable to open angular distribution " << filename << " at AngularDistribution::ReadFile!" << std::endl;
+			return false;
+		}
+
+		std::vector<std::pair<double, double>> points; //theta (rad), dsigma/dOmega
+		std::string line;
+		double thetaMin = 180.0, thetaMax = 0.0; //deg
+		while(std::getline(input, line))
+		{
+			std::stringstream lineStream(line);
+			double theta, density;
+			if(line.empty() || line[0] == '#' || !(lineStream >> theta >> density))
+				continue;
+			if(theta < 0.0 || theta > 180.0 || density < 0.0)
+			{
+				std::cerr << "Angular distribution " << filename << " has a point outside 0-180 deg or below zero at AngularDistribution::ReadFile!" << std::endl;
+				return false;
+			}
+			points.emplace_back(theta * M_PI / 180.0, density);
+			thetaMin = std::min(thetaMin, theta);
+			thetaMax = std::max(thetaMax, theta);
+		}
+		std::sort(points.begin(), points.end());
+		//The distribution is zero outside the table, so a table that stops short of 0 or 180 deg cuts the angles it leaves out
+		if(!points.empty() && (thetaMin > 0.0 || thetaMax < 180.0))
+		{
+			std::cerr << "Warning: angular distribution " << filename << " only covers " << thetaMin << "-" << thetaMax
+					  << " deg, angles outside it are never sampled at AngularDistribution::ReadFile!" << std::endl;
+		}
+
+		//Weight of a bin is the integral of dsigma/dOmega over its solid angle, 2*pi*d(cos(theta)) with the density linear in cos(theta)
+		std::vector<double> weights;
+		for(std::size_t i=0; i+1<points.size(); i++)
+		{
+			Bin bin;
+			bin.cosLow = std::cos(points[i].first);
+			bin.cosWidth = std::cos(points[i + 1].first) - bin.cosLow;
+			bin.densityLow = points[i].second;
+			bin.densityHigh = points[i + 1].second;
+			bin.probability = 1.0;
+			bin.alias = 0;
+			double weight = 0.5 * (bin.densityLow + bin.densityHigh) * std::fabs(bin.cosWidth);
+			if(weight <= 0.0)
+				continue;
+			m_bins.push_back(bin);
+			weights.push_back(weight);
+		}
+		if(m_bins.empty())
+		{
+			std::cerr << "Angular distribution " << filename << " has no positive weight at AngularDistribution::ReadFile!" << std::endl;
+			return false;
+		}
+
+		BuildAliasTable(weights);
+		return true;
+	}
+
+	void AngularDistribution::BuildAliasTable(const std::vector<double>& weights)
+	{
+		const std::size_t nBins = weights.size();
+		double total = 0.0;
+		for(double weight : weights)
+			total += weight;
+
+		std::vector<double> scaled(nBins);
+		std::vector<uint32_t> small, large;
+		for(std::size_t i=0; i<nBins; i++)
+		{
+			scaled[i] = weights[i] * nBins / total;
+			if(scaled[i] < 1.0)
+				small.push_back(i);
+			else
+				large.push_back(i);
+		}
+
+		while(!small.empty() && !large.empty())
+		{
+			uint32_t less = small.back();
+			small.pop_back();
+			uint32_t more = large.back();
+			m_bins[less].probability = scaled[less];
+			m_bins[less].alias = more;
+			scaled[more] -= 1.0 - scaled[less];
+			if(scaled[more] < 1.0)
+			{
+				large.pop_back();
+				small.push_back(more);
+			}
+		}
+		//Whatever is left is 1 up to rounding
+		for(uint32_t i : large)
+			m_bins[i].probability = 1.0;
+		for(uint32_t i : small)
+			m_bins[i].probability = 1.0;
+	}
+
+	double AngularDistribution::SampleTheta() const
+	{
+		if(m_bins.empty())
+			return std::acos(RandomGenerator::GetUniformReal(s_cosThetaMin, s_cosThetaMax));
+
+		double u = RandomGenerator::GetUniformFraction() * m_bins.size();
+		std::size_t index = std::min(std::size_t(u), m_bins.size() - 1);
+		const Bin* bin = &m_bins[index];
+		if(u - index >= bin->probability)
+			bin = &m_bins[bin->alias];
+
+		//Invert the linear density (1-t)*densityLow + t*densityHigh over t in [0, 1]
+		double v = RandomGenerator::GetUniformFraction();
+		double slope = bin->densityHigh - bin->densityLow;
+		double t = v;
+		if(std::fabs(slope) > 1.0e-12 * (bin->densityLow + bin->densityHigh))
+			t = (std::sqrt(bin->densityLow * bin->densityLow + v * (bin->densityHigh * bin->densityHigh - bin->densityLow * bin->densityLow)) - bin->densityLow) / slope;
+		return std::acos(std::clamp(bin->cosLow + t * bin->cosWidth, s_cosThetaMin, s_cosThetaMax));
+	}
+
+}
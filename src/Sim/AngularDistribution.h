@@ -0,0 +1,58 @@
+/*
+	AngularDistribution.h
+	Centre of mass polar angle distribution of a two-body step. Empty, it is isotropic. Read from a table of dsigma/dOmega,
+	each interval between table angles becomes one bin of a Walker alias table weighted by its solid angle, and inside a bin
+	the distribution is taken as linear in cos(theta). A sample is then one alias lookup and one analytic inversion,
+	whatever the shape of the table.
+
+	Table format (# starts a comment line), one point per line, in any order:
+
+	<thetaCM (deg)> <dsigma/dOmega (any units)>
+
+	The density is zero outside the table's angles, so a table should run from 0 to 180 deg; ReadFile warns if it does not.
+*/
+#ifndef ANGULAR_DISTRIBUTION_H
+#define ANGULAR_DISTRIBUTION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AnasenSim {
+
+	class AngularDistribution
+	{
+	public:
+		AngularDistribution();
+		~AngularDistribution();
+
+		//Returns false, leaving the distribution isotropic, if the file could not be read or has no positive weight
+		bool ReadFile(const std::string& filename);
+		bool IsIsotropic() const { return m_bins.empty(); }
+
+		//Polar angle in rad. The isotropic case draws exactly as acos(Uniform(-1, 1))
+		double SampleTheta() const;
+
+	private:
+		struct Bin
+		{
+			double cosLow; //cos(theta) at the bin's first table point
+			double cosWidth; //Signed step to the second table point
+			double densityLow; //dsigma/dOmega at each end
+			double densityHigh;
+			double probability; //Alias table: keep this bin with this probability, else take alias
+			uint32_t alias;
+		};
+
+		//Walker/Vose alias table from the bin weights
+		void BuildAliasTable(const std::vector<double>& weights);
+
+		std::vector<Bin> m_bins;
+
+		static constexpr double s_cosThetaMin = -1.0;
+		static constexpr double s_cosThetaMax = 1.0;
+	};
+
+}
+
+#endif
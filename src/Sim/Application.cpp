@@ -1,12 +1,22 @@
 #include "Application.h"
 #include "TFile.h"
 #include "TTree.h"
-#include "DecaySystem.h"
-#include "OneStepSystem.h"
-#include "TwoStepSystem.h"
+#include "TNamed.h"
+#include "TParameter.h"
+#include "TDirectory.h"
+#include "Detectors/DetectorValidation.h"
+#include "RandomGenerator.h"
+#include "Utils/MemoryUsage.h"
+#include "Utils/Timer.h"
+#include "Utils/ChildProcess.h"
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace AnasenSim {
 
@@ -22,8 +32,12 @@ namespace AnasenSim {
 
     Application::~Application()
     {
+		for(std::size_t i=1; i<m_workerSystems.size(); i++)
+			delete m_workerSystems[i];
 		delete m_system;
 		delete m_array;
+		for(AnasenArray* variant : m_variants)
+			delete variant;
     }
 
     void Application::InitConfig(const std::filesystem::path& config)
@@ -44,6 +58,64 @@ namespace AnasenSim {
 		configFile>>junk>>m_outputName;
 		configFile >> junk >> deadChannelFile;
 		configFile>>junk>>m_nSamples;
+
+		//Optional settings, each a single "Key: value" pair, may precede the target block
+		std::string tableCacheDir = "None";
+		std::string ensembleFile = "None";
+		std::string geometryFile = "None";
+		std::string massFile = "None";
+		while(configFile >> junk)
+		{
+			if(junk == "begin_target")
+				break;
+			else if(junk == "TableCache:")
+				configFile >> tableCacheDir;
+			else if(junk == "GeometryFile:")
+				configFile >> geometryFile;
+			else if(junk == "GeometryEnsemble:")
+				configFile >> ensembleFile;
+			else if(junk == "MassFile:")
+				configFile >> massFile;
+			else if(junk == "StopAtPrecision:")
+				configFile >> m_stopMinDetected >> m_stopPrecision;
+			else if(junk == "TimeBudget:")
+				configFile >> m_timeBudget;
+			else if(junk == "CheckpointInterval:")
+				configFile >> m_checkpointInterval;
+			else if(junk == "Sweep:")
+			{
+				if(!ReadSweep(configFile))
+					return;
+			}
+			else if(junk == "ReplayFile:")
+			{
+				configFile >> m_replayName;
+				if(m_replayName == "None")
+					m_replayName.clear();
+			}
+			else if(junk == "Seed:")
+			{
+				configFile >> m_seed;
+				m_isSeeded = true;
+			}
+			else if(junk == "NumberOfThreads:")
+			{
+				configFile >> m_nThreads;
+				if(m_nThreads == 0)
+					m_nThreads = std::max(1u, std::thread::hardware_concurrency());
+			}
+			else
+			{
+				std::cerr << "Unrecognized option " << junk << " at Application::InitConfig!" << std::endl;
+				return;
+			}
+		}
+
+		//Masses are needed from the target on, so they are settled before anything else is built
+		if(massFile == "None")
+			MassLookup::GetInstance().UseEmbeddedTable();
+		else if(!MassLookup::GetInstance().LoadFile(massFile))
+			return;
 		
 		double density;
 		std::vector<uint32_t> avec, zvec;
@@ -51,7 +123,7 @@ namespace AnasenSim {
 		uint32_t z, a;
 		int s;
 		
-		configFile>>junk>>junk>>density;
+		configFile>>junk>>density;
 		avec.clear(); zvec.clear(); svec.clear();
 		while(configFile>>junk) 
 		{
@@ -88,6 +160,68 @@ namespace AnasenSim {
             }
 			else if (junk == "end_chain")
 				break;
+			else if(junk == "AngularDistribution:")
+			{
+				//Optional, after the excitation of the step it belongs to
+				configFile >> junk;
+				if(params.stepParams.empty())
+				{
+					std::cerr << "AngularDistribution given before any step at Application::InitConfig!" << std::endl;
+					return;
+				}
+				else if(params.stepParams.back().rxnType == RxnType::PhaseSpace)
+				{
+					std::cerr << "AngularDistribution given for a PhaseSpace step, which has no two-body angle, at Application::InitConfig!" << std::endl;
+					return;
+				}
+				if(junk != "None" && !params.stepParams.back().angularDistribution.ReadFile(junk))
+					return;
+			}
+			else if(junk == "Lineshape:")
+			{
+				//Optional like AngularDistribution: Normal (default), Gaussian, BreitWigner <width>, Table <file> or States <file>
+				configFile >> junk;
+				if(params.stepParams.empty())
+				{
+					std::cerr << "Lineshape given before any step at Application::InitConfig!" << std::endl;
+					return;
+				}
+				Lineshape& lineshape = params.stepParams.back().lineshape;
+				switch(Lineshape::StringToType(junk))
+				{
+					case Lineshape::Type::Normal:
+					{
+						if(junk != "Normal")
+						{
+							std::cerr << "Unknown lineshape " << junk << " at Application::InitConfig!" << std::endl;
+							return;
+						}
+						break;
+					}
+					case Lineshape::Type::Gaussian: lineshape.SetGaussian(); break;
+					case Lineshape::Type::BreitWigner:
+					{
+						double width;
+						configFile >> width;
+						lineshape.SetBreitWigner(width);
+						break;
+					}
+					case Lineshape::Type::Table:
+					{
+						configFile >> junk;
+						if(!lineshape.ReadTable(junk))
+							return;
+						break;
+					}
+					case Lineshape::Type::States:
+					{
+						configFile >> junk;
+						if(!lineshape.ReadStates(junk))
+							return;
+						break;
+					}
+				}
+			}
 			else if(junk == "begin_step")
 			{
 				StepParameters currentParams;
@@ -121,6 +255,20 @@ namespace AnasenSim {
 					configFile >> junk >> currentParams.sigmaResidualEx;
 					params.stepParams.push_back(currentParams);
 				}
+				else if(currentParams.rxnType == RxnType::PhaseSpace)
+				{
+					//Decaying nucleus and any number of products, up to end_nuclei; the last product is the remainder
+					configFile >> junk;
+					while(configFile >> junk && junk != "end_nuclei")
+					{
+						configFile >> a;
+						currentParams.Z.push_back(std::stoi(junk));
+						currentParams.A.push_back(a);
+					}
+					configFile >> junk >> currentParams.meanResidualEx;
+					configFile >> junk >> currentParams.sigmaResidualEx;
+					params.stepParams.push_back(currentParams);
+				}
 				else
 				{
 					std::cerr << "Invalid reaction information at SimApp::InitConfig!" << std::endl;
@@ -129,9 +277,59 @@ namespace AnasenSim {
 			}
 		}
 
+		if(m_sweepParameter == SweepParameter::ResidualExcitationMean && m_sweepStep >= params.stepParams.size())
+		{
+			std::cerr << "Sweep of ResidualExcitationMean names step " << m_sweepStep << " but the chain has " << params.stepParams.size()
+					  << " steps at Application::InitConfig!" << std::endl;
+			return;
+		}
+		else if(m_sweepParameter == SweepParameter::ResidualExcitationMean &&
+				(params.stepParams[m_sweepStep].lineshape.GetType() == Lineshape::Type::Table ||
+				 params.stepParams[m_sweepStep].lineshape.GetType() == Lineshape::Type::States))
+		{
+			//Table and States shapes fix their own excitations, so the mean would change nothing
+			std::cerr << "Sweep of ResidualExcitationMean names step " << m_sweepStep << ", whose Table or States lineshape does not use the mean,"
+					  << " at Application::InitConfig!" << std::endl;
+			return;
+		}
+		else if(!m_sweepValues.empty() && !m_replayName.empty())
+		{
+			std::cerr << "A sweep cannot be combined with a replay at Application::InitConfig!" << std::endl;
+			return;
+		}
+
+		m_params = params;
 		m_system = CreateSystem(params);
-		m_array = new AnasenArray(params.target);
-		if(deadChannelFile != "None")
+		AnasenGeometry geometry;
+		if(geometryFile != "None" && !ReadGeometryFile(geometryFile, geometry))
+			return;
+		m_array = new AnasenArray(params.target, geometry);
+		if(deadChannelFile.find(',') != std::string::npos)
+		{
+			//Comma separated list of maps: detection is evaluated once and a per-map bitmask is written alongside
+			std::stringstream fileList(deadChannelFile);
+			std::string filename;
+			while(std::getline(fileList, filename, ','))
+			{
+				if(filename.empty())
+					continue;
+				DeadChannelMap map;
+				map.ReadFile(filename);
+				if(!map.IsValid())
+				{
+					std::cerr << "Failed to load dead channel map " << filename << " at Application::InitConfig!" << std::endl;
+					return;
+				}
+				m_deadMaps.push_back(map);
+				m_deadMapNames.push_back(filename);
+			}
+			if(m_deadMaps.size() > s_maxDeadMaps)
+			{
+				std::cerr << "At most " << s_maxDeadMaps << " dead channel maps are supported at Application::InitConfig!" << std::endl;
+				return;
+			}
+		}
+		else if(deadChannelFile != "None")
 			m_array->SetDeadChannelMap(deadChannelFile);
 		if(m_system == nullptr || !m_system->IsValid())
 		{
@@ -139,69 +337,899 @@ namespace AnasenSim {
 			return;
 		}
 
+		//Each worker generates with its own system; the detector arrays are shared read-only
+		m_workerSystems.push_back(m_system);
+		for(uint32_t i=1; i<m_nThreads; i++)
+			m_workerSystems.push_back(CreateSystem(params));
+		for(uint32_t i=0; i<m_nThreads; i++)
+		{
+			if(m_isSeeded)
+			{
+				m_workerEngines.emplace_back(GetWorkerSeed(i, 0));
+				m_contexts.emplace_back(GetWorkerSeed(i, 1));
+			}
+			else
+			{
+				m_workerEngines.emplace_back(std::random_device()());
+				m_contexts.emplace_back();
+			}
+		}
+		//The threads live as long as the application: every block of every sweep point (or of a replay) is handed to them
+		m_workerPool.Start(m_nThreads);
+
+		if(ensembleFile != "None")
+		{
+			if(!m_deadMaps.empty())
+			{
+				std::cerr << "A geometry ensemble cannot be combined with a list of dead channel maps at Application::InitConfig!" << std::endl;
+				return;
+			}
+			std::vector<GeometryVariant> variants;
+			if(!ReadGeometryEnsemble(ensembleFile, geometry, variants))
+				return;
+			for(const GeometryVariant& variant : variants)
+			{
+				m_variants.push_back(new AnasenArray(params.target, variant.geometry));
+				if(deadChannelFile != "None")
+					m_variants.back()->SetDeadChannelMap(deadChannelFile);
+				m_variantNames.push_back(variant.name);
+			}
+			m_variantEvents.resize(m_variants.size());
+		}
+
+		std::unique_ptr<TableCache> cache;
+		if(tableCacheDir != "None")
+			cache = std::make_unique<TableCache>(tableCacheDir);
+		std::vector<NucleusRecord> nuclei;
+		m_system->GetNuclei(nuclei);
+		m_array->InitEnergyLossTables(nuclei, cache.get());
+		for(AnasenArray* variant : m_variants)
+			variant->InitEnergyLossTables(nuclei, cache.get());
+
 		std::getline(configFile, junk);
 		std::getline(configFile, junk);
 
 		std::cout << "Output file: " << m_outputName << std::endl;
+		for(const std::string& name : m_deadMapNames)
+			std::cout << "Dead channel map: " << name << std::endl;
+		for(const std::string& name : m_variantNames)
+			std::cout << "Geometry variant: " << name << std::endl;
+		if(!m_replayName.empty())
+			std::cout << "Replaying detection on events from: " << m_replayName << std::endl;
 		std::cout << "Reaction equation: " << m_system->GetSystemEquation() << std::endl;
 		std::cout << "Number of samples: " << m_nSamples << std::endl;
+		std::cout << "Number of threads: " << m_nThreads << std::endl;
+		if(m_isSeeded)
+			std::cout << "Random seed: " << m_seed << std::endl;
+		if(m_stopPrecision > 0.0)
+			std::cout << "Stopping at a relative uncertainty of " << m_stopPrecision << " on the efficiency for " << m_stopMinDetected
+					  << " or more detected nuclei" << std::endl;
+		if(m_timeBudget > 0.0)
+			std::cout << "Time budget: " << m_timeBudget << " s" << std::endl;
+		if(m_checkpointInterval > 0.0)
+			std::cout << "Checkpoint interval: " << m_checkpointInterval << " s" << std::endl;
+		if(!m_sweepValues.empty())
+			std::cout << "Sweep of " << SweepParameterToString(m_sweepParameter) << ": " << m_sweepValues.size() << " points from "
+					  << m_sweepValues.front() << " to " << m_sweepValues.back() << std::endl;
 
 		std::cout << "Configuration loaded successfully" << std::endl;
 
         m_isInit = true;
     }
 
-	void Application::Run()
+	bool Application::Run()
 	{
 		if(!m_isInit)
         {
             std::cerr << "Application not initialized at Application::Run()!" << std::endl;
-            return;
+            return false;
         }
+		else if(!m_replayName.empty())
+		{
+			return RunReplay();
+		}
 
-        TFile* outputFile = TFile::Open(m_outputName.c_str(), "RECREATE");
+        TFile* outputFile = TFile::Open(m_outputName.c_str(), m_isResume ? "UPDATE" : "RECREATE");
         if(!outputFile || !outputFile->IsOpen())
         {
             std::cerr << "Could not open output file " << m_outputName << " at Application::Run() " << std::endl;
-            return;
+            return false;
         }
 
-        TTree* outtree = new TTree("SimTree", "SimTree");
-        outtree->Branch("event", m_system->GetNuclei());
+		RunState state;
+		std::size_t nPoints = m_sweepValues.empty() ? 1 : m_sweepValues.size();
+		if(m_isResume && !ReadCheckpoint(outputFile, state))
+		{
+			outputFile->Close();
+			delete outputFile;
+			return false;
+		}
+		else if(state.point >= nPoints)
+		{
+			std::cout << "The run in " << m_outputName << " is already complete, nothing to resume" << std::endl;
+			outputFile->Close();
+			delete outputFile;
+			return true;
+		}
+
+		if(m_isResume)
+			std::cout << "Resuming simulation at event " << state.nEvents << (m_sweepValues.empty() ? "" : " of sweep point " + std::to_string(state.point)) << "..." << std::endl;
+		else
+			std::cout << "Starting simulation..." << std::endl;
+		AllocationCount startAllocations = GetAllocationCount();
+
+		//Each grid point of a sweep is written to its own directory; tables, geometry and workers carry over between points
+		uint64_t nEvents = 0;
+		for(std::size_t i=state.point; i<nPoints; i++)
+		{
+			if(!m_sweepValues.empty())
+			{
+				std::cout << "Sweep point " << i << ": " << SweepParameterToString(m_sweepParameter) << " = " << m_sweepValues[i] << std::endl;
+				if(!SetSweepPoint(i))
+				{
+					std::cerr << "Skipping sweep point " << i << ", the reaction system is not valid there" << std::endl;
+					state = RunState();
+					state.point = i + 1;
+					continue;
+				}
+			}
+			nEvents += RunEvents(outputFile, GetRunDirectory(outputFile, i), state);
+			if(!m_sweepValues.empty())
+			{
+				WriteSweepValue(i);
+				std::cout << std::endl;
+			}
+
+			state = RunState();
+			state.point = i + 1;
+			if(m_checkpointInterval > 0.0)
+				WriteCheckpoint(outputFile, nullptr, state);
+		}
+
+        outputFile->cd();
+		WriteDeadMapNames();
+        outputFile->Close();
+        delete outputFile;
+
+		std::cout << std::endl << "Simulation complete" << std::endl;
+		PrintMemoryReport(nEvents, startAllocations);
+		return true;
+	}
+
+	bool Application::Resume()
+	{
+		if(!m_replayName.empty())
+		{
+			std::cerr << "A replay cannot be resumed at Application::Resume()!" << std::endl;
+			return false;
+		}
+		m_isResume = true;
+		bool isDone = Run();
+		m_isResume = false;
+		return isDone;
+	}
+
+	uint64_t Application::RunEvents(TFile* file, TDirectory* directory, RunState& state)
+	{
+		directory->cd();
+		//A resumed tree is attached through pointers to the branch buffers, which must outlive the loop
+		std::vector<Nucleus>* eventAddress = &m_event;
+		std::vector<uint64_t>* detectionMaskAddress = &m_detectionMask;
+		std::vector<std::vector<Nucleus>*> variantAddresses;
+		for(std::vector<Nucleus>& variantEvent : m_variantEvents)
+			variantAddresses.push_back(&variantEvent);
+
+		TTree* outtree = nullptr;
+		if(state.nEvents != 0)
+		{
+			directory->GetObject("SimTree", outtree);
+			outtree->SetBranchAddress("event", &eventAddress);
+			if(!m_deadMaps.empty())
+				outtree->SetBranchAddress("detectionMask", &detectionMaskAddress);
+			for(std::size_t i=0; i<m_variants.size(); i++)
+				outtree->SetBranchAddress(("event_" + m_variantNames[i]).c_str(), &variantAddresses[i]);
+		}
+		else
+		{
+			outtree = new TTree("SimTree", "SimTree");
+			outtree->Branch("event", &m_event);
+			if(!m_deadMaps.empty())
+				outtree->Branch("detectionMask", &m_detectionMask);
+			for(std::size_t i=0; i<m_variants.size(); i++)
+				outtree->Branch(("event_" + m_variantNames[i]).c_str(), &m_variantEvents[i]);
+		}
+		//With checkpoints the tree header may only reach the file in WriteCheckpoint: an automatic AutoSave during Fill would
+		//store an entry count that matches neither checkpoint, and the run could not be resumed
+		if(m_treeAutoSave != 0)
+			outtree->SetAutoSave(m_treeAutoSave);
+		if(m_checkpointInterval > 0.0)
+			outtree->SetAutoSave(0);
 
         double flushPercent = 0.01;
         uint64_t flushVal = flushPercent * m_nSamples;
         uint64_t count = 0, flushCount = 0;
+		if(flushVal != 0)
+		{
+			count = state.nEvents % flushVal;
+			flushCount = state.nEvents / flushVal;
+		}
 
-		std::cout << "Starting simulation..." << std::endl;
+		Timer timer;
+		timer.Start();
+		double lastCheckpoint = 0.0; //s on timer
+		std::vector<uint64_t> workerPassed(m_nThreads, 0); //Efficiency events of each worker, summed between blocks
+		uint64_t nPassed = state.nPassed;
 
-		std::vector<Nucleus>* eventHandle = m_system->GetNuclei();
+		//Events are generated and detected in blocks by the workers, then written in order
+		std::vector<EventRecord> records(std::min<uint64_t>(s_eventsPerBlock, m_nSamples));
+		uint64_t nDone = state.nEvents;
+		while(nDone < m_nSamples)
+		{
+			std::size_t blockSize = std::min<uint64_t>(records.size(), m_nSamples - nDone);
+			m_workerPool.Run(blockSize, [this, &records, &workerPassed](std::size_t worker, std::size_t begin, std::size_t end)
+			{
+				RandomGenerator::SetEngine(m_workerEngines[worker]);
+				uint64_t passed = 0;
+				for(std::size_t i=begin; i<end; i++)
+				{
+					GenerateEvent(worker, records[i]);
+					passed += IsEfficiencyEvent(records[i]);
+				}
+				m_workerEngines[worker] = RandomGenerator::GetEngine();
+				workerPassed[worker] = passed;
+			});
 
-        for(uint64_t i=0; i<m_nSamples; i++)
-        {
-            count++;
-            if(count == flushVal)
-            {
-                count = 0;
-                flushCount++;
-                std::cout << "\rPercent of data simulated: " << flushCount * flushPercent * 100 << "%" << std::flush;
-            }
+			for(std::size_t i=0; i<blockSize; i++)
+			{
+				count++;
+				if(count == flushVal)
+				{
+					count = 0;
+					flushCount++;
+					std::cout << "\rPercent of data simulated: " << flushCount * flushPercent * 100 << "%" << std::flush;
+				}
+				FillRecord(records[i], outtree);
+			}
+			nDone += blockSize;
+			if(m_abortAfterEvents != 0 && nDone >= m_abortAfterEvents)
+			{
+				//Leave the file as the last checkpoint (or any automatic AutoSave) wrote it, without closing it
+				std::cout << std::endl << "Ending the run abruptly after " << nDone << " events" << std::endl;
+				std::_Exit(s_resumeCheckExitCode);
+			}
 
-            m_system->RunSystem();
-			for(Nucleus& nucleus : *eventHandle)
+			for(uint64_t& passed : workerPassed)
 			{
-				m_array->IsDetected(nucleus);
+				nPassed += passed;
+				passed = 0;
 			}
-            outtree->Fill();
-			m_system->ResetNucleiDetected();
-        }
+			timer.Stop();
+			double elapsed = state.elapsed + timer.GetElapsedSeconds();
+			if(IsPrecisionReached(nPassed, nDone))
+			{
+				std::cout << std::endl << "Efficiency precision reached after " << nDone << " events" << std::endl;
+				break;
+			}
+			else if(m_timeBudget > 0.0 && elapsed >= m_timeBudget && nDone < m_nSamples)
+			{
+				std::cout << std::endl << "Time budget used after " << nDone << " events" << std::endl;
+				break;
+			}
+			else if(m_checkpointInterval > 0.0 && timer.GetElapsedSeconds() - lastCheckpoint >= m_checkpointInterval && nDone < m_nSamples)
+			{
+				RunState current = state;
+				current.nEvents = nDone;
+				current.nPassed = nPassed;
+				current.elapsed = elapsed;
+				WriteCheckpoint(file, outtree, current);
+				lastCheckpoint = timer.GetElapsedSeconds();
+			}
+		}
+		uint64_t nGenerated = nDone - state.nEvents;
+		state.nEvents = nDone;
+		state.nPassed = nPassed;
 
-        outputFile->cd();
+		if(m_stopPrecision > 0.0 && nDone != 0)
+			std::cout << std::endl << "Efficiency for " << m_stopMinDetected << " or more detected nuclei: " << double(nPassed) / nDone
+					  << " (" << nPassed << " of " << nDone << " events)" << std::endl;
+
+        directory->cd();
         outtree->Write(outtree->GetName(), TObject::kOverwrite);
-        outputFile->Close();
-        delete outputFile;
+		TParameter<Long64_t> nTotal("NumberOfEvents", nDone);
+		nTotal.Write(nTotal.GetName(), TObject::kOverwrite);
+		return nGenerated;
+	}
 
-		std::cout << std::endl << "Simulation complete" << std::endl;
+	/*
+		The checkpoint is written before the tree is flushed, and the one before it is kept alongside. Whichever step an
+		interruption lands on, one of the two matches the entries the file holds for the tree, and ReadCheckpoint takes that one.
+	*/
+	void Application::WriteCheckpoint(TFile* file, TTree* tree, const RunState& state)
+	{
+		std::string current = SerializeState(state);
+		file->cd();
+		if(!m_lastCheckpoint.empty())
+		{
+			TNamed previous("PreviousCheckpoint", m_lastCheckpoint.c_str());
+			previous.Write(previous.GetName(), TObject::kOverwrite);
+		}
+		TNamed checkpoint("Checkpoint", current.c_str());
+		checkpoint.Write(checkpoint.GetName(), TObject::kOverwrite);
+		m_lastCheckpoint = current;
+
+		if(tree != nullptr)
+			tree->AutoSave("SaveSelf");
+		file->SaveSelf(kTRUE);
+	}
+
+	bool Application::ReadCheckpoint(TFile* file, RunState& state)
+	{
+		std::vector<std::mt19937_64> workerEngines, contextEngines;
+		for(const char* name : {"Checkpoint", "PreviousCheckpoint"})
+		{
+			TNamed* checkpoint = nullptr;
+			file->GetObject(name, checkpoint);
+			if(checkpoint == nullptr)
+				continue;
+			std::string text = checkpoint->GetTitle();
+			delete checkpoint;
+			RunState candidate;
+			if(!DeserializeState(text, candidate, workerEngines, contextEngines))
+				return false;
+
+			//The tree of the point in progress must hold exactly the events the checkpoint counted
+			uint64_t nWritten = 0;
+			TDirectory* directory = nullptr;
+			if(m_sweepValues.empty())
+				directory = candidate.point == 0 ? file : nullptr;
+			else if(candidate.point < m_sweepValues.size())
+				directory = file->GetDirectory(("point" + std::to_string(candidate.point)).c_str());
+			if(directory != nullptr)
+			{
+				TTree* tree = nullptr;
+				directory->GetObject("SimTree", tree);
+				if(tree != nullptr)
+					nWritten = tree->GetEntries();
+			}
+			if(nWritten != candidate.nEvents)
+				continue;
+
+			state = candidate;
+			m_workerEngines = workerEngines;
+			for(std::size_t i=0; i<m_contexts.size(); i++)
+				m_contexts[i].generator = contextEngines[i];
+			m_lastCheckpoint = text;
+			return true;
+		}
+		std::cerr << "No checkpoint in " << m_outputName << " matches the events it holds at Application::ReadCheckpoint!" << std::endl;
+		return false;
+	}
+
+	//Header line "point nEvents nPassed elapsed nThreads", then the event and detector random streams of each worker
+	std::string Application::SerializeState(const RunState& state) const
+	{
+		std::stringstream stream;
+		stream.precision(17);
+		stream << state.point << " " << state.nEvents << " " << state.nPassed << " " << state.elapsed << " " << m_nThreads << "\n";
+		for(uint32_t i=0; i<m_nThreads; i++)
+			stream << m_workerEngines[i] << "\n" << m_contexts[i].generator << "\n";
+		return stream.str();
+	}
+
+	bool Application::DeserializeState(const std::string& text, RunState& state, std::vector<std::mt19937_64>& workerEngines,
+									   std::vector<std::mt19937_64>& contextEngines) const
+	{
+		std::stringstream stream(text);
+		uint32_t nThreads = 0;
+		stream >> state.point >> state.nEvents >> state.nPassed >> state.elapsed >> nThreads;
+		if(!stream || nThreads != m_nThreads)
+		{
+			std::cerr << "Checkpoint was written with " << nThreads << " threads, but " << m_nThreads
+					  << " are configured at Application::DeserializeState!" << std::endl;
+			return false;
+		}
+		workerEngines.resize(nThreads);
+		contextEngines.resize(nThreads);
+		for(uint32_t i=0; i<nThreads; i++)
+			stream >> workerEngines[i] >> contextEngines[i];
+		if(!stream)
+		{
+			std::cerr << "Checkpoint random streams could not be read at Application::DeserializeState!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	//The file itself without a sweep, else the directory of the grid point (made if it does not exist yet)
+	TDirectory* Application::GetRunDirectory(TFile* file, std::size_t point) const
+	{
+		if(m_sweepValues.empty())
+			return file;
+		std::string title = SweepParameterToString(m_sweepParameter) + " = " + std::to_string(m_sweepValues[point]);
+		return file->mkdir(("point" + std::to_string(point)).c_str(), title.c_str(), true);
+	}
+
+	//Workers only read the record they just made, so this is safe from any of them
+	bool Application::IsEfficiencyEvent(const EventRecord& record) const
+	{
+		uint32_t nDetected = 0;
+		for(const NucleusRecord& nucleus : record.event)
+			nDetected += nucleus.isDetected;
+		return nDetected >= m_stopMinDetected;
+	}
+
+	/*
+		Relative uncertainty from the 1 sigma Wilson score interval for k of N events passing: half-width over centre. Unlike
+		the normal approximation sqrt(p(1 - p)/N), it does not collapse to zero when no events, or all of them, pass. The stop
+		also waits for s_stopMinOutcomes of each outcome, so an efficiency of 0 or 1 runs to NumberOfSamples.
+	*/
+	bool Application::IsPrecisionReached(uint64_t nPassed, uint64_t nEvents) const
+	{
+		if(m_stopPrecision <= 0.0 || nPassed < s_stopMinOutcomes || nEvents - nPassed < s_stopMinOutcomes)
+			return false;
+		double n = nEvents;
+		double k = nPassed;
+		double centre = k + 0.5;
+		double halfWidth = std::sqrt(k * (n - k) / n + 0.25);
+		return halfWidth / centre < m_stopPrecision;
+	}
+
+	/*
+		The nuclei of the chain are the same at every point, so the energy loss tables built at InitConfig stay valid; only
+		the systems (excitation limits, beam tables) are rebuilt, and a density point rescales the tables in place.
+		The random streams carry on from the previous point.
+	*/
+	bool Application::SetSweepPoint(std::size_t point)
+	{
+		double value = m_sweepValues[point];
+		switch(m_sweepParameter)
+		{
+			case SweepParameter::None: return true;
+			case SweepParameter::ResidualExcitationMean: m_params.stepParams[m_sweepStep].meanResidualEx = value; break;
+			case SweepParameter::InitialBeamEnergy:
+			{
+				if(!m_params.sampleBeam && m_params.rxnBeamEnergy > value)
+					return false;
+				m_params.initialBeamEnergy = value;
+				break;
+			}
+			case SweepParameter::Density:
+			{
+				m_params.target.SetDensity(value);
+				m_array->SetGasDensity(value);
+				for(AnasenArray* variant : m_variants)
+					variant->SetGasDensity(value);
+				break;
+			}
+		}
+
+		for(std::size_t i=0; i<m_workerSystems.size(); i++)
+		{
+			delete m_workerSystems[i];
+			m_workerSystems[i] = CreateSystem(m_params);
+		}
+		m_system = m_workerSystems[0];
+		return std::all_of(m_workerSystems.begin(), m_workerSystems.end(), [](const ReactionChain* system) { return system->IsValid(); });
+	}
+
+	void Application::WriteSweepValue(std::size_t point) const
+	{
+		TParameter<double> value(SweepParameterToString(m_sweepParameter).c_str(), m_sweepValues[point]);
+		value.Write(value.GetName(), TObject::kOverwrite);
+	}
+
+	bool Application::RunValidation(const std::string& settingsFile)
+	{
+		if(!m_isInit)
+		{
+			std::cerr << "Application not initialized at Application::RunValidation()!" << std::endl;
+			return false;
+		}
+
+		ValidationSettings settings;
+		if(!ReadValidationSettings(settingsFile, settings))
+			return false;
+
+		DetectorValidation validation(m_params.target, m_array->GetGeometry(), settings);
+		std::vector<NucleusRecord> nuclei;
+		m_system->GetNuclei(nuclei);
+		return validation.Run(nuclei);
+	}
+
+	/*
+		Events are generated, detected and staged into the branch buffers exactly as in Run, on a single worker, minus the
+		TTree::Fill (ROOT's own buffering is outside our control). After the warm up every buffer has reached its steady-state
+		capacity, so any allocation counted afterwards is a per-event allocation.
+	*/
+	bool Application::RunAllocationCheck()
+	{
+		if(!m_isInit)
+		{
+			std::cerr << "Application not initialized at Application::RunAllocationCheck()!" << std::endl;
+			return false;
+		}
+		else if(!IsAllocationCountingEnabled())
+		{
+			std::cerr << "Allocation counting is not built in; reconfigure with -DASIM_COUNT_ALLOCATIONS=On to run the allocation check" << std::endl;
+			return false;
+		}
+
+		EventRecord record;
+		RandomGenerator::SetEngine(m_workerEngines[0]);
+		for(uint64_t i=0; i<s_allocationCheckWarmup; i++)
+		{
+			GenerateEvent(0, record);
+			StageRecord(record);
+		}
+
+		AllocationCount start = GetAllocationCount();
+		for(uint64_t i=0; i<s_allocationCheckEvents; i++)
+		{
+			GenerateEvent(0, record);
+			StageRecord(record);
+		}
+		AllocationCount end = GetAllocationCount();
+		m_workerEngines[0] = RandomGenerator::GetEngine();
+
+		uint64_t nAllocations = end.count - start.count;
+		std::cout << "Allocation check: " << nAllocations << " heap allocations (" << end.bytes - start.bytes << " bytes) in "
+				  << s_allocationCheckEvents << " events after " << s_allocationCheckWarmup << " warm up events" << std::endl;
+		if(nAllocations != 0)
+		{
+			std::cout << "Allocation check FAILED: the event loop allocates" << std::endl;
+			return false;
+		}
+		std::cout << "Allocation check passed" << std::endl;
+		return true;
+	}
+
+	/*
+		Resume check. Both runs checkpoint after every block and set the tree's AutoSave to a few entries, so an automatic
+		AutoSave would land between two checkpoints if checkpointing did not switch it off. The interrupted run is a child
+		process that ends without closing its file after s_resumeCheckAbortBlocks blocks, before that block's checkpoint, as a
+		crash would. Resuming it must give the events and final random streams of the uninterrupted run.
+	*/
+	bool Application::RunResumeCheck(const std::string& config)
+	{
+		if(!m_isInit)
+		{
+			std::cerr << "Application not initialized at Application::RunResumeCheck()!" << std::endl;
+			return false;
+		}
+		else if(!m_isSeeded || !m_replayName.empty() || m_nSamples <= s_resumeCheckAbortBlocks * s_eventsPerBlock)
+		{
+			std::cerr << "The resume check needs a seeded simulation (not a replay) of more than " << s_resumeCheckAbortBlocks * s_eventsPerBlock
+					  << " events at Application::RunResumeCheck()!" << std::endl;
+			return false;
+		}
+
+		std::string outputName = m_outputName;
+		std::string referenceName = outputName + ".reference";
+		std::string resumedName = outputName + ".resumed";
+		std::string referenceState, resumedState;
+		uint64_t nReference = 0, nResumed = 0;
+
+		PrepareResumeCheck(referenceName);
+		bool isRun = Run() && ReadFinalState(referenceName, referenceState, nReference);
+		if(isRun)
+		{
+			int status = RunSelf({"--check-resume-interrupt", config, resumedName});
+			if(status != s_resumeCheckExitCode)
+			{
+				std::cerr << "The interrupted run did not end where planned (exit status " << status << ") at Application::RunResumeCheck()!" << std::endl;
+				isRun = false;
+			}
+		}
+		PrepareResumeCheck(resumedName);
+		isRun = isRun && Resume() && ReadFinalState(resumedName, resumedState, nResumed);
+
+		std::error_code ec;
+		std::filesystem::remove(referenceName, ec);
+		std::filesystem::remove(resumedName, ec);
+		m_outputName = outputName;
+		if(!isRun)
+		{
+			std::cout << "Resume check FAILED: a run did not complete" << std::endl;
+			return false;
+		}
+		else if(nResumed != nReference || resumedState != referenceState)
+		{
+			std::cout << "Resume check FAILED: the resumed run wrote " << nResumed << " events against " << nReference
+					  << (resumedState != referenceState ? ", and its random streams differ" : "") << std::endl;
+			return false;
+		}
+		std::cout << "Resume check passed: " << nResumed << " events, identical to the uninterrupted run" << std::endl;
+		return true;
+	}
+
+	bool Application::RunInterrupted(const std::string& outputName)
+	{
+		if(!m_isInit)
+			return false;
+		PrepareResumeCheck(outputName);
+		m_abortAfterEvents = s_resumeCheckAbortBlocks * s_eventsPerBlock;
+		Run();
+		std::cerr << "The run reached its end before it could be interrupted at Application::RunInterrupted()!" << std::endl;
+		return false;
+	}
+
+	void Application::PrepareResumeCheck(const std::string& outputName)
+	{
+		m_outputName = outputName;
+		m_checkpointInterval = std::numeric_limits<double>::min();
+		m_treeAutoSave = s_resumeCheckAutoSave;
+		m_lastCheckpoint.clear();
+	}
+
+	bool Application::ReadFinalState(const std::string& filename, std::string& state, uint64_t& nEvents) const
+	{
+		TFile* file = TFile::Open(filename.c_str(), "READ");
+		if(!file || !file->IsOpen())
+		{
+			delete file;
+			return false;
+		}
+
+		TNamed* checkpoint = nullptr;
+		file->GetObject("Checkpoint", checkpoint);
+		bool isFound = checkpoint != nullptr;
+		if(isFound)
+			state = checkpoint->GetTitle();
+		delete checkpoint;
+		nEvents = 0;
+		std::size_t nPoints = m_sweepValues.empty() ? 1 : m_sweepValues.size();
+		for(std::size_t i=0; i<nPoints; i++)
+		{
+			TDirectory* directory = m_sweepValues.empty() ? file : file->GetDirectory(("point" + std::to_string(i)).c_str());
+			TTree* tree = nullptr;
+			if(directory != nullptr)
+				directory->GetObject("SimTree", tree);
+			if(tree != nullptr)
+				nEvents += tree->GetEntries();
+		}
+		file->Close();
+		delete file;
+		return isFound;
+	}
+
+	/*
+		Detection-only replay. Generator-level values are read back from the SimTree of a previous run and only
+		AnasenArray::IsDetected is re-run, with whatever detector settings (dead channels, geometry, thresholds) this
+		build and configuration use. Results are written as a new SimTree in the output file.
+	*/
+	bool Application::RunReplay()
+	{
+		TFile* inputFile = TFile::Open(m_replayName.c_str(), "READ");
+		if(!inputFile || !inputFile->IsOpen())
+		{
+			std::cerr << "Could not open replay file " << m_replayName << " at Application::RunReplay() " << std::endl;
+			delete inputFile;
+			return false;
+		}
+
+		TTree* intree = (TTree*) inputFile->Get("SimTree");
+		if(intree == nullptr)
+		{
+			std::cerr << "Replay file " << m_replayName << " has no SimTree at Application::RunReplay()" << std::endl;
+			inputFile->Close();
+			delete inputFile;
+			return false;
+		}
+		std::vector<Nucleus>* inputEvent = nullptr;
+		intree->SetBranchAddress("event", &inputEvent);
+
+		TFile* outputFile = TFile::Open(m_outputName.c_str(), "RECREATE");
+		if(!outputFile || !outputFile->IsOpen())
+		{
+			std::cerr << "Could not open output file " << m_outputName << " at Application::RunReplay() " << std::endl;
+			inputFile->Close();
+			delete inputFile;
+			delete outputFile;
+			return false;
+		}
+
+		TTree* outtree = new TTree("SimTree", "SimTree");
+		outtree->Branch("event", &m_event);
+		if(!m_deadMaps.empty())
+			outtree->Branch("detectionMask", &m_detectionMask);
+		for(std::size_t i=0; i<m_variants.size(); i++)
+			outtree->Branch(("event_" + m_variantNames[i]).c_str(), &m_variantEvents[i]);
+
+		uint64_t nEntries = intree->GetEntries();
+		double flushPercent = 0.01;
+		uint64_t flushVal = flushPercent * nEntries;
+		uint64_t count = 0, flushCount = 0;
+
+		std::cout << "Starting replay of " << nEntries << " events..." << std::endl;
+		AllocationCount startAllocations = GetAllocationCount();
+
+		//Input is read on this thread (ROOT I/O is not shared between threads); only detection runs on the workers
+		std::vector<EventRecord> records(std::min<uint64_t>(s_eventsPerBlock, nEntries));
+		uint64_t nDone = 0;
+		while(nDone < nEntries)
+		{
+			std::size_t blockSize = std::min<uint64_t>(records.size(), nEntries - nDone);
+			for(std::size_t i=0; i<blockSize; i++)
+			{
+				intree->GetEntry(nDone + i);
+				records[i].event.resize(inputEvent->size());
+				for(std::size_t j=0; j<inputEvent->size(); j++)
+				{
+					records[i].event[j] = ToNucleusRecord((*inputEvent)[j]);
+					ResetNucleusDetection(records[i].event[j]);
+				}
+			}
+
+			m_workerPool.Run(blockSize, [this, &records](std::size_t worker, std::size_t begin, std::size_t end)
+			{
+				for(std::size_t i=begin; i<end; i++)
+					DetectEvent(records[i], m_contexts[worker]);
+			});
+
+			for(std::size_t i=0; i<blockSize; i++)
+			{
+				count++;
+				if(count == flushVal)
+				{
+					count = 0;
+					flushCount++;
+					std::cout << "\rPercent of data replayed: " << flushCount * flushPercent * 100 << "%" << std::flush;
+				}
+				FillRecord(records[i], outtree);
+			}
+			nDone += blockSize;
+		}
+
+		outputFile->cd();
+		outtree->Write(outtree->GetName(), TObject::kOverwrite);
+		WriteDeadMapNames();
+		outputFile->Close();
+		delete outputFile;
+		inputFile->Close();
+		delete inputFile;
+
+		std::cout << std::endl << "Replay complete" << std::endl;
+		PrintMemoryReport(nEntries, startAllocations);
+		return true;
+	}
+
+	void Application::GenerateEvent(std::size_t worker, EventRecord& record)
+	{
+		ReactionChain* system = m_workerSystems[worker];
+		system->RunSystem();
+		system->GetNuclei(record.event);
+		DetectEvent(record, m_contexts[worker]);
+	}
+
+	/*
+		Run detection on every nucleus of an event. With a list of dead channel maps, the event keeps the response with all
+		channels alive and detectionMask[i] holds the per-map result for nucleus i (bit k set if detected with map k).
+		With a geometry ensemble, each variant's response is written to its own event_<name> branch.
+		Called concurrently by the workers, each with its own record and context.
+	*/
+	void Application::DetectEvent(EventRecord& record, DetectorContext& context) const
+	{
+		//Geometry variants share the generated event; each gets its own copy to detect. Event detection must still be clear here.
+		record.variantEvents.resize(m_variants.size());
+		for(std::size_t i=0; i<m_variants.size(); i++)
+		{
+			record.variantEvents[i] = record.event;
+			m_variants[i]->IsDetected(record.variantEvents[i], context);
+		}
+
+		if(m_deadMaps.empty())
+			m_array->IsDetected(record.event, context);
+		else
+			m_array->IsDetected(record.event, m_deadMaps, record.detectionMask, context);
+	}
+
+	//The branch buffers are reused from event to event, so conversion only allocates when an event grows or changes species
+	void Application::StageRecord(EventRecord& record)
+	{
+		m_event.resize(record.event.size());
+		for(std::size_t i=0; i<record.event.size(); i++)
+			ToNucleus(record.event[i], m_event[i]);
+		std::swap(m_detectionMask, record.detectionMask);
+		for(std::size_t i=0; i<m_variantEvents.size(); i++)
+		{
+			const std::vector<NucleusRecord>& variantEvent = record.variantEvents[i];
+			m_variantEvents[i].resize(variantEvent.size());
+			for(std::size_t j=0; j<variantEvent.size(); j++)
+				ToNucleus(variantEvent[j], m_variantEvents[i][j]);
+		}
+	}
+
+	void Application::FillRecord(EventRecord& record, TTree* tree)
+	{
+		StageRecord(record);
+		tree->Fill();
+	}
+
+	void Application::PrintMemoryReport(uint64_t nEvents, const AllocationCount& start) const
+	{
+		std::cout << "Peak RSS: " << GetPeakRSS() / (1024 * 1024) << " MB" << std::endl;
+		if(!IsAllocationCountingEnabled() || nEvents == 0)
+			return;
+		AllocationCount end = GetAllocationCount();
+		std::cout << "Heap allocations: " << end.count - start.count << " (" << double(end.count - start.count) / nEvents << " per event, "
+				  << double(end.bytes - start.bytes) / nEvents << " bytes per event, including output)" << std::endl;
+	}
+
+	//Sweep: <parameter> [<step>] <first> <last> <nPoints>, with the step index given only for ResidualExcitationMean
+	bool Application::ReadSweep(std::istream& input)
+	{
+		std::string parameter;
+		input >> parameter;
+		if(parameter == "ResidualExcitationMean")
+		{
+			m_sweepParameter = SweepParameter::ResidualExcitationMean;
+			input >> m_sweepStep;
+		}
+		else if(parameter == "InitialBeamEnergy")
+			m_sweepParameter = SweepParameter::InitialBeamEnergy;
+		else if(parameter == "Density")
+			m_sweepParameter = SweepParameter::Density;
+		else
+		{
+			std::cerr << "Unknown sweep parameter " << parameter << " at Application::ReadSweep!" << std::endl;
+			return false;
+		}
+
+		double first, last;
+		std::size_t nPoints = 0;
+		input >> first >> last >> nPoints;
+		if(!input || nPoints == 0)
+		{
+			std::cerr << "Sweep needs a first value, a last value and at least one point at Application::ReadSweep!" << std::endl;
+			return false;
+		}
+		m_sweepValues.clear();
+		for(std::size_t i=0; i<nPoints; i++)
+			m_sweepValues.push_back(nPoints == 1 ? first : first + (last - first) * i / (nPoints - 1));
+		if(m_sweepParameter == SweepParameter::Density &&
+		   std::any_of(m_sweepValues.begin(), m_sweepValues.end(), [](double density) { return density <= 0.0; }))
+		{
+			std::cerr << "Swept density must stay above zero at Application::ReadSweep!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	std::string Application::SweepParameterToString(SweepParameter parameter)
+	{
+		switch(parameter)
+		{
+			case SweepParameter::None: return "None";
+			case SweepParameter::ResidualExcitationMean: return "ResidualExcitationMean";
+			case SweepParameter::InitialBeamEnergy: return "InitialBeamEnergy";
+			case SweepParameter::Density: return "Density";
+		}
+		return "None";
+	}
+
+	uint64_t Application::GetWorkerSeed(uint32_t worker, uint32_t stream) const
+	{
+		std::seed_seq sequence{uint32_t(m_seed), uint32_t(m_seed >> 32), worker, stream};
+		uint32_t words[2];
+		sequence.generate(words, words + 2);
+		return (uint64_t(words[1]) << 32) | words[0];
+	}
+
+	//Record which map each detectionMask bit refers to, in bit order
+	void Application::WriteDeadMapNames()
+	{
+		if(m_deadMapNames.empty())
+			return;
+
+		std::string names;
+		for(std::size_t i=0; i<m_deadMapNames.size(); i++)
+		{
+			if(i != 0)
+				names += ",";
+			names += m_deadMapNames[i];
+		}
+		TNamed deadMapList("DeadChannelMaps", names.c_str());
+		deadMapList.Write(deadMapList.GetName(), TObject::kOverwrite);
 	}
 
-}
\ No newline at end of file
+}
@@ -1,47 +1,168 @@
 #ifndef SIM_APP_H
 #define SIM_APP_H
 
-#include "ReactionSystem.h"
+#include "ReactionChain.h"
 #include "Detectors/AnasenArray.h"
+#include "Utils/AllocationCounter.h"
+#include "Utils/WorkerPool.h"
 
 #include <string>
 #include <vector>
 #include <memory>
 #include <filesystem>
 
+class TTree;
+class TDirectory;
+class TFile;
+
 namespace AnasenSim {
 
     class Application
     {
     public:
 
-        struct Chunk
+        //One event and its detector response(s), produced by a worker and written to the tree in order by the main thread.
+        //Events stay in the working form until StageRecord converts them into the branch buffers
+        struct EventRecord
         {
-            ReactionSystem* system = nullptr;
-            AnasenArray* array = nullptr;
-            uint64_t samples = 0;
+            std::vector<NucleusRecord> event;
+            std::vector<uint64_t> detectionMask;
+            std::vector<std::vector<NucleusRecord>> variantEvents;
         };
 
         Application(const std::filesystem::path& config);
         ~Application();
 
-        void Run();
-        void RunSingleThread();
+        //Run the simulation (or replay) into OutputFile. Returns false if it could not be run
+        bool Run();
+        //Continue the run stored in the output file from its last checkpoint (see CheckpointInterval); the configuration,
+        //including the number of threads, must be the same as for the interrupted run. Returns false if it could not be resumed
+        bool Resume();
+        //Differential check of the fast detector paths for this configuration's gas, geometry and nuclei. Returns true if it passed
+        bool RunValidation(const std::string& settingsFile);
+        //Runs the steady-state event loop (generate, detect, record) and returns true if it made no heap allocations.
+        //Requires a build with ASIM_COUNT_ALLOCATIONS
+        bool RunAllocationCheck();
+        //Runs this configuration uninterrupted, and interrupted part way (a crash, in a child process) then resumed, and
+        //returns true if both give the same events. config is this configuration's file, passed on to the child
+        bool RunResumeCheck(const std::string& config);
+        //The child of RunResumeCheck: runs into outputName and ends the process abruptly part way. Returns false if it got to the end
+        bool RunInterrupted(const std::string& outputName);
 
         bool IsInit()  const { return m_isInit; }
+        const std::string& GetOutputName() const { return m_outputName; }
+        uint64_t GetNumberOfSamples() const { return m_nSamples; }
 
     private:
+        static constexpr std::size_t s_maxDeadMaps = 64; //One bit each in detectionMask
+        static constexpr std::size_t s_eventsPerBlock = 8192; //Events held in memory between tree fills
+        static constexpr uint64_t s_stopMinOutcomes = 10; //Passed and failed events each needed before StopAtPrecision can end a run
+        static constexpr uint64_t s_allocationCheckWarmup = 10000; //Events run before counting, so buffers reach their steady-state size
+        static constexpr uint64_t s_allocationCheckEvents = 100000;
+        static constexpr int64_t s_resumeCheckAutoSave = 1000; //Entries; far below ROOT's default, so it lands between checkpoints
+        static constexpr uint64_t s_resumeCheckAbortBlocks = 3; //Blocks written before the interrupted run ends
+        static constexpr int s_resumeCheckExitCode = 3;
+
+        //Progress of a run, saved with each checkpoint
+        struct RunState
+        {
+            std::size_t point = 0; //Sweep point in progress (0 without a sweep)
+            uint64_t nEvents = 0; //Events of that point already written
+            uint64_t nPassed = 0; //Of which counted towards the stopping efficiency
+            double elapsed = 0.0; //s spent on the point, for the time budget
+        };
+
+        //Input value scanned by a sweep; every grid point is a full run of NumberOfSamples events
+        enum class SweepParameter
+        {
+            None,
+            ResidualExcitationMean,
+            InitialBeamEnergy,
+            Density
+        };
+
         void InitConfig(const std::filesystem::path& config);
+        bool ReadSweep(std::istream& input);
+        bool RunReplay();
+        //Generate, detect and write up to m_nSamples events to a SimTree in directory, stopping early once a stopping
+        //criterion is met. A state with events continues the tree already in directory. Returns the number of events written
+        uint64_t RunEvents(TFile* file, TDirectory* directory, RunState& state);
+        //Save the state and every random stream next to the output, then flush the tree so its entries match
+        void WriteCheckpoint(TFile* file, TTree* tree, const RunState& state);
+        //Load the checkpoint that matches what was written to file. Returns false if there is none
+        bool ReadCheckpoint(TFile* file, RunState& state);
+        //Checkpoint after every block, a small tree AutoSave and output to outputName, for the resume check
+        void PrepareResumeCheck(const std::string& outputName);
+        //Final checkpoint and number of events written of a finished run, for the resume check
+        bool ReadFinalState(const std::string& filename, std::string& state, uint64_t& nEvents) const;
+        std::string SerializeState(const RunState& state) const;
+        bool DeserializeState(const std::string& text, RunState& state, std::vector<std::mt19937_64>& workerEngines,
+                              std::vector<std::mt19937_64>& contextEngines) const;
+        TDirectory* GetRunDirectory(TFile* file, std::size_t point) const;
+        //Event counts towards the stopping efficiency: at least m_stopMinDetected of its nuclei were detected
+        bool IsEfficiencyEvent(const EventRecord& record) const;
+        bool IsPrecisionReached(uint64_t nPassed, uint64_t nEvents) const;
+        //Set the swept value of a grid point and rebuild what depends on it (the systems; the gas density of the arrays).
+        //Returns false if the point gives an invalid system
+        bool SetSweepPoint(std::size_t point);
+        void WriteSweepValue(std::size_t point) const;
+        static std::string SweepParameterToString(SweepParameter parameter);
+        //Generate one event with the worker's system and random stream (already loaded into RandomGenerator) and detect it
+        void GenerateEvent(std::size_t worker, EventRecord& record);
+        void DetectEvent(EventRecord& record, DetectorContext& context) const;
+        //Convert a record into the branch buffers (the persisted Nucleus form)
+        void StageRecord(EventRecord& record);
+        void FillRecord(EventRecord& record, TTree* tree);
+        //Peak RSS, and heap allocations per event since start when allocation counting is built in
+        void PrintMemoryReport(uint64_t nEvents, const AllocationCount& start) const;
+        void WriteDeadMapNames();
+        //Independent seed for each worker (and each random stream of a worker) from the configured seed
+        uint64_t GetWorkerSeed(uint32_t worker, uint32_t stream) const;
 
         bool m_isInit;
 
         std::string m_outputName = "";
+        std::string m_replayName = ""; //Existing SimTree file to re-run detection on; empty for a full simulation
         uint64_t m_nSamples = 0;
-        uint32_t m_nThreads = 0;
+        uint32_t m_nThreads = 1;
+        bool m_isSeeded = false; //With a seed, a run is reproducible for a given number of threads
+        uint64_t m_seed = 0;
+
+        //Optional stopping criteria, checked between blocks; NumberOfSamples is then the most events a run may take.
+        //Zero disables each one
+        double m_stopPrecision = 0.0; //Relative uncertainty on the efficiency
+        uint32_t m_stopMinDetected = 2;
+        double m_timeBudget = 0.0; //s, per run of events (per sweep point)
+
+        double m_checkpointInterval = 0.0; //s between checkpoints; zero disables them
+        bool m_isResume = false;
+        std::string m_lastCheckpoint; //Serialized state of the previous checkpoint, kept until the next one is on disk
+        int64_t m_treeAutoSave = 0; //TTree::SetAutoSave of the SimTree when not checkpointing; zero keeps ROOT's default
+        uint64_t m_abortAfterEvents = 0; //Resume check only: end the process, as a crash would, once this many events are written
+
+        SweepParameter m_sweepParameter = SweepParameter::None;
+        std::size_t m_sweepStep = 0; //Step whose ResidualExcitationMean is swept
+        std::vector<double> m_sweepValues; //Grid points; empty without a sweep
 
-        ReactionSystem* m_system;
+        std::vector<DeadChannelMap> m_deadMaps; //Fan-out maps; empty when a single (or no) map is used
+        std::vector<std::string> m_deadMapNames;
+        std::vector<Nucleus> m_event; //Branch buffers, filled from an EventRecord just before each TTree::Fill
+        std::vector<uint64_t> m_detectionMask; //One entry per nucleus of the current event
+
+        std::vector<AnasenArray*> m_variants; //Geometry ensemble, in addition to the nominal m_array
+        std::vector<std::string> m_variantNames;
+        std::vector<std::vector<Nucleus>> m_variantEvents; //Per-variant detector response for the current event
+
+        SystemParameters m_params;
+        ReactionChain* m_system;
         AnasenArray* m_array;
 
+        //Per-worker generator and detector state; worker 0 uses m_system. The arrays are shared by all workers
+        std::vector<ReactionChain*> m_workerSystems;
+        std::vector<DetectorContext> m_contexts;
+        std::vector<std::mt19937_64> m_workerEngines; //Event generation random stream of each worker, loaded into RandomGenerator while it runs
+        WorkerPool m_workerPool;
+
     };
 }
 
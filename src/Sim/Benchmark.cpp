@@ -0,0 +1,283 @@
+#include "Benchmark.h"
+#include "Application.h"
+#include "Utils/Timer.h"
+#include "Utils/MemoryUsage.h"
+#include "Utils/ChildProcess.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <unistd.h>
+
+namespace AnasenSim {
+
+	//Value following "key": on a line written by WriteResults
+	static bool ExtractField(const std::string& line, const std::string& key, std::string& value)
+	{
+		std::string pattern = "\"" + key + "\": ";
+		std::size_t pos = line.find(pattern);
+		if(pos == std::string::npos)
+			return false;
+		pos += pattern.size();
+		if(line[pos] == '"')
+		{
+			std::size_t end = line.find('"', pos + 1);
+			if(end == std::string::npos)
+				return false;
+			value = line.substr(pos + 1, end - pos - 1);
+		}
+		else
+			value = line.substr(pos, line.find_first_of(",}", pos) - pos);
+		return true;
+	}
+
+	Benchmark::Benchmark(const std::string& benchmarkFile)
+	{
+		std::ifstream input(benchmarkFile);
+		if(!input.is_open())
+		{
+			std::cerr << "Unable to open benchmark file " << benchmarkFile << std::endl;
+			return;
+		}
+
+		std::string junk, name, config;
+		while(input >> junk)
+		{
+			if(junk[0] == '#')
+				std::getline(input, junk);
+			else if(junk == "RegressionThreshold:")
+				input >> m_threshold;
+			else if(junk == "Baseline:")
+				input >> m_baseline;
+			else if(junk == "Benchmark:")
+			{
+				input >> name >> config;
+				m_benchmarks.emplace_back(name, config);
+			}
+			else
+			{
+				std::cerr << "Error parsing benchmark file " << benchmarkFile << "! Bad entry " << junk << std::endl;
+				return;
+			}
+		}
+
+		if(m_benchmarks.empty())
+		{
+			std::cerr << "Benchmark file " << benchmarkFile << " lists no benchmarks" << std::endl;
+			return;
+		}
+		m_isValid = true;
+	}
+
+	Benchmark::~Benchmark() {}
+
+	bool Benchmark::Run(const std::string& resultsFile, const std::string& baselineFile)
+	{
+		if(!m_isValid)
+			return false;
+
+		std::vector<BenchmarkResult> results;
+		for(const auto& benchmark : m_benchmarks)
+		{
+			BenchmarkResult result;
+			if(!RunInChild(benchmark.first, benchmark.second, result))
+				return false;
+			results.push_back(result);
+		}
+
+		std::streamsize precision = std::cout.precision();
+		std::cout << std::endl << std::left << std::setw(20) << "Benchmark" << std::right << std::setw(12) << "Events" << std::setw(14) << "Events/s"
+				  << std::setw(14) << "PeakRSS (MB)" << std::setw(14) << "Bytes/event" << std::endl;
+		for(const BenchmarkResult& result : results)
+		{
+			std::cout << std::left << std::setw(20) << result.name << std::right << std::setw(12) << result.nEvents << std::fixed << std::setprecision(1)
+					  << std::setw(14) << result.eventsPerSecond << std::setw(14) << result.peakRSS << std::setw(14) << result.bytesPerEvent
+					  << std::defaultfloat << std::setprecision(precision) << std::endl;
+		}
+
+		if(!WriteResults(resultsFile, results))
+			return false;
+		std::cout << "Benchmark results written to " << resultsFile << std::endl;
+
+		//Throughput depends on the machine, so the default baseline is not shipped: it is a results file from this machine
+		std::string baselineName = baselineFile;
+		if(baselineName.empty())
+		{
+			if(m_baseline.empty())
+				return true;
+			else if(!std::filesystem::exists(m_baseline))
+			{
+				std::cout << "No baseline at " << m_baseline << ", regressions not checked. Copy a results file from a reference build there to enable the check" << std::endl;
+				return true;
+			}
+			baselineName = m_baseline;
+		}
+		std::cout << "Comparing against baseline " << baselineName << std::endl;
+		std::vector<BenchmarkResult> baseline;
+		if(!ReadResults(baselineName, baseline))
+			return false;
+		return CompareToBaseline(results, baseline);
+	}
+
+	bool Benchmark::RunSingle(const std::string& name, const std::string& config, const std::string& resultsFile)
+	{
+		BenchmarkResult result;
+		if(!RunBenchmark(name, config, result))
+			return false;
+		return WriteResults(resultsFile, {result});
+	}
+
+	bool Benchmark::RunInChild(const std::string& name, const std::string& config, BenchmarkResult& result) const
+	{
+		std::string resultsFile = (std::filesystem::temp_directory_path() / ("AnasenSim_benchmark_" + std::to_string(getpid()) + "_" + name + ".json")).string();
+		int status = RunSelf({"--benchmark-single", name, config, resultsFile});
+		std::vector<BenchmarkResult> results;
+		bool isDone = status == 0 && ReadResults(resultsFile, results) && results.size() == 1;
+		std::error_code ec;
+		std::filesystem::remove(resultsFile, ec);
+		if(!isDone)
+		{
+			std::cerr << "Benchmark " << name << " did not complete" << std::endl;
+			return false;
+		}
+		result = results[0];
+		return true;
+	}
+
+	//Output file size is measured after the run, then the file is removed
+	bool Benchmark::RunBenchmark(const std::string& name, const std::string& config, BenchmarkResult& result)
+	{
+		std::cout << "Running benchmark " << name << " (" << config << ")" << std::endl;
+		ResetPeakRSS();
+
+		Application app(config);
+		if(!app.IsInit())
+		{
+			std::cerr << "Benchmark " << name << " failed to load configuration " << config << std::endl;
+			return false;
+		}
+
+		Timer timer;
+		timer.Start();
+		bool isDone = app.Run();
+		timer.Stop();
+		if(!isDone)
+		{
+			std::cerr << "Benchmark " << name << " failed to run configuration " << config << std::endl;
+			return false;
+		}
+
+		result.name = name;
+		result.config = config;
+		result.nEvents = app.GetNumberOfSamples();
+		result.eventsPerSecond = timer.GetElapsedSeconds() > 0.0 ? result.nEvents / timer.GetElapsedSeconds() : 0.0;
+		result.peakRSS = GetPeakRSS() / (1024.0 * 1024.0);
+
+		std::error_code ec;
+		uintmax_t outputSize = std::filesystem::file_size(app.GetOutputName(), ec);
+		if(!ec && result.nEvents != 0)
+			result.bytesPerEvent = double(outputSize) / result.nEvents;
+		std::filesystem::remove(app.GetOutputName(), ec);
+		return true;
+	}
+
+	//Lower throughput, or higher memory/output size, beyond the threshold is a regression
+	bool Benchmark::CompareToBaseline(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline) const
+	{
+		bool isPassed = true;
+		std::streamsize precision = std::cout.precision();
+		for(const BenchmarkResult& result : results)
+		{
+			const BenchmarkResult* reference = nullptr;
+			for(const BenchmarkResult& entry : baseline)
+			{
+				if(entry.name == result.name)
+					reference = &entry;
+			}
+			if(reference == nullptr)
+			{
+				std::cout << result.name << ": no baseline entry" << std::endl;
+				continue;
+			}
+
+			bool isRegressed = false;
+			if(result.eventsPerSecond < reference->eventsPerSecond * (1.0 - m_threshold))
+			{
+				std::cout << result.name << ": REGRESSION in events/s, " << result.eventsPerSecond << " vs. baseline " << reference->eventsPerSecond << std::endl;
+				isRegressed = true;
+			}
+			if(result.peakRSS > reference->peakRSS * (1.0 + m_threshold))
+			{
+				std::cout << result.name << ": REGRESSION in peak RSS, " << result.peakRSS << " MB vs. baseline " << reference->peakRSS << " MB" << std::endl;
+				isRegressed = true;
+			}
+			if(result.bytesPerEvent > reference->bytesPerEvent * (1.0 + m_threshold))
+			{
+				std::cout << result.name << ": REGRESSION in bytes/event, " << result.bytesPerEvent << " vs. baseline " << reference->bytesPerEvent << std::endl;
+				isRegressed = true;
+			}
+			if(!isRegressed)
+				std::cout << result.name << ": OK (" << std::showpos << std::fixed << std::setprecision(1)
+						  << 100.0 * (result.eventsPerSecond / reference->eventsPerSecond - 1.0) << "% events/s)"
+						  << std::noshowpos << std::defaultfloat << std::setprecision(precision) << std::endl;
+			isPassed &= !isRegressed;
+		}
+
+		std::cout << (isPassed ? "No regressions" : "Benchmark regressions found") << " (threshold " << m_threshold * 100.0 << "%)" << std::endl;
+		return isPassed;
+	}
+
+	bool Benchmark::WriteResults(const std::string& filename, const std::vector<BenchmarkResult>& results)
+	{
+		std::ofstream output(filename);
+		if(!output.is_open())
+		{
+			std::cerr << "Unable to open benchmark results file " << filename << std::endl;
+			return false;
+		}
+
+		output << std::setprecision(10);
+		output << "{" << std::endl << "  \"benchmarks\": [" << std::endl;
+		for(std::size_t i=0; i<results.size(); i++)
+		{
+			const BenchmarkResult& result = results[i];
+			output << "    {\"name\": \"" << result.name << "\", \"config\": \"" << result.config << "\", \"events\": " << result.nEvents
+				   << ", \"eventsPerSecond\": " << result.eventsPerSecond << ", \"peakRSSMB\": " << result.peakRSS
+				   << ", \"bytesPerEvent\": " << result.bytesPerEvent << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+		}
+		output << "  ]" << std::endl << "}" << std::endl;
+		return true;
+	}
+
+	bool Benchmark::ReadResults(const std::string& filename, std::vector<BenchmarkResult>& results)
+	{
+		std::ifstream input(filename);
+		if(!input.is_open())
+		{
+			std::cerr << "Unable to open benchmark baseline " << filename << std::endl;
+			return false;
+		}
+
+		std::string line, value;
+		while(std::getline(input, line))
+		{
+			BenchmarkResult result;
+			if(!ExtractField(line, "name", result.name))
+				continue;
+			ExtractField(line, "config", result.config);
+			if(ExtractField(line, "events", value))
+				result.nEvents = std::strtoull(value.c_str(), nullptr, 10);
+			if(ExtractField(line, "eventsPerSecond", value))
+				result.eventsPerSecond = std::strtod(value.c_str(), nullptr);
+			if(ExtractField(line, "peakRSSMB", value))
+				result.peakRSS = std::strtod(value.c_str(), nullptr);
+			if(ExtractField(line, "bytesPerEvent", value))
+				result.bytesPerEvent = std::strtod(value.c_str(), nullptr);
+			results.push_back(result);
+		}
+		return true;
+	}
+
+}
@@ -0,0 +1,68 @@
+/*
+	Benchmark.h
+	End-to-end throughput benchmark. Each reference configuration is run as a full simulation (generation, detection
+	and output) and its events per second, peak RSS and output file bytes per event are recorded in a JSON results file.
+	Given a stored baseline (a results file from an earlier build), any benchmark slower, or larger in memory or output,
+	by more than the regression threshold is flagged. The configurations should set a Seed so every run does the same work.
+	Each benchmark runs in a process of its own (this binary re-executed with --benchmark-single), so the range tables, catima
+	state and peak RSS of one configuration are not carried into the next and every benchmark is measured from a cold start.
+
+	Benchmark file format (# starts a comment line):
+
+	RegressionThreshold: <fraction, e.g. 0.1 for 10%>
+	Baseline: <results_file>   (optional; compared against when no baseline is given on the command line)
+	Benchmark: <name> <input_file>
+	...
+*/
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace AnasenSim {
+
+	struct BenchmarkResult
+	{
+		std::string name;
+		std::string config;
+		uint64_t nEvents = 0;
+		double eventsPerSecond = 0.0;
+		double peakRSS = 0.0; //MB
+		double bytesPerEvent = 0.0;
+	};
+
+	class Benchmark
+	{
+	public:
+		Benchmark(const std::string& benchmarkFile);
+		~Benchmark();
+
+		bool IsValid() const { return m_isValid; }
+		//Runs every benchmark and writes resultsFile. Compares against baselineFile, or if it is empty the Baseline of the
+		//benchmark file when that exists, and returns false if any benchmark regressed
+		bool Run(const std::string& resultsFile, const std::string& baselineFile);
+		//Runs one benchmark in this process and writes its result to resultsFile; the body of each child started by Run
+		static bool RunSingle(const std::string& name, const std::string& config, const std::string& resultsFile);
+
+	private:
+		//Re-execute the binary (Linux /proc/self/exe) to run the benchmark, and read back the result it writes
+		bool RunInChild(const std::string& name, const std::string& config, BenchmarkResult& result) const;
+		static bool RunBenchmark(const std::string& name, const std::string& config, BenchmarkResult& result);
+		bool CompareToBaseline(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline) const;
+
+		static bool WriteResults(const std::string& filename, const std::vector<BenchmarkResult>& results);
+		//Reads files written by WriteResults (one benchmark object per line)
+		static bool ReadResults(const std::string& filename, std::vector<BenchmarkResult>& results);
+
+		std::vector<std::pair<std::string, std::string>> m_benchmarks; //name, input file
+		double m_threshold = 0.1;
+		std::string m_baseline; //Default baseline results file; empty if none is configured
+		bool m_isValid = false;
+	};
+
+}
+
+#endif
@@ -0,0 +1,360 @@
+#include "ChainSystem.h"
+#include "RandomGenerator.h"
+
+#include "Math/Boost.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace AnasenSim {
+
+	ChainSystem::ChainSystem(const SystemParameters& params) :
+		ReactionSystem(params), m_hasReaction(false), m_rxnPathLength(0.0), m_beamStraggling(0.0), m_rxnBeamEnergy(0.0),
+		m_beamTheta(0.0), m_beamPhi(0.0)
+	{
+		Init();
+	}
+
+	ChainSystem::~ChainSystem() {}
+
+	void ChainSystem::Init()
+	{
+		const std::vector<StepParameters>& stepParams = m_params.stepParams;
+		if(stepParams.empty())
+		{
+			m_isValid = false;
+			std::cerr << "Invalid parameters at ChainSystem::Init(), the chain has no steps!" << std::endl;
+			return;
+		}
+
+		//Nucleus slots used by each step: target (or decaying parent), projectile, and the products with the residual last
+		struct StepSlots
+		{
+			std::size_t target, projectile, firstProduct, nProducts;
+		};
+		std::vector<StepSlots> stepSlots;
+		std::vector<std::size_t> slotStep; //Step which produced each slot
+		std::vector<bool> isDecayed;
+
+		auto addNucleus = [&](int z, int a, Nucleus::ReactionRole role, std::size_t step)
+		{
+			m_nuclei.push_back(CreateNucleus(z, a, role, step == s_noStep ? 0 : step));
+			slotStep.push_back(step);
+			isDecayed.push_back(false);
+			return m_nuclei.size() - 1;
+		};
+
+		for(std::size_t i=0; i<stepParams.size(); i++)
+		{
+			const StepParameters& step = stepParams[i];
+			bool isReaction = step.rxnType == RxnType::Reaction;
+			bool isValidType = (isReaction && i == 0) || step.rxnType == RxnType::Decay || step.rxnType == RxnType::PhaseSpace;
+			std::size_t nListed = step.Z.size();
+			bool isValidSize = nListed == step.A.size() && (step.rxnType == RxnType::PhaseSpace ? nListed >= 2 : nListed == (isReaction ? 3 : 2));
+			if(!isValidType || !isValidSize)
+			{
+				m_isValid = false;
+				std::cerr << "Invalid parameters at ChainSystem::Init(), step " << i << " must be a decay (only the first step may be a reaction)!" << std::endl;
+				return;
+			}
+
+			StepSlots slots;
+			if(i == 0)
+			{
+				slots.target = addNucleus(step.Z[0], step.A[0], Nucleus::ReactionRole::Target, s_noStep);
+				slots.projectile = isReaction ? addNucleus(step.Z[1], step.A[1], Nucleus::ReactionRole::Projectile, s_noStep) : s_noStep;
+			}
+			else
+			{
+				//First undecayed product of an earlier step with this species, residuals before other products
+				slots.target = s_noStep;
+				for(std::size_t j=0; j<stepSlots.size() && slots.target == s_noStep; j++)
+				{
+					for(std::size_t k=0; k<stepSlots[j].nProducts; k++)
+					{
+						std::size_t slot = stepSlots[j].firstProduct + (k == 0 ? stepSlots[j].nProducts - 1 : k - 1);
+						if(!isDecayed[slot] && int(m_nuclei[slot].Z) == step.Z[0] && int(m_nuclei[slot].A) == step.A[0])
+						{
+							slots.target = slot;
+							break;
+						}
+					}
+				}
+				if(slots.target == s_noStep)
+				{
+					m_isValid = false;
+					std::cerr << "Invalid parameters at ChainSystem::Init(), step " << i << " decays (Z,A): (" << step.Z[0] << "," << step.A[0]
+							  << ") which is not an undecayed product of an earlier step!" << std::endl;
+					return;
+				}
+				isDecayed[slots.target] = true;
+				slots.projectile = s_noStep;
+			}
+
+			//Listed products (after the target, and projectile for a reaction); the residual is what remains
+			std::size_t firstListed = isReaction ? 2 : 1;
+			int zr = step.Z[0] + (isReaction ? step.Z[1] : 0);
+			int ar = step.A[0] + (isReaction ? step.A[1] : 0);
+			for(std::size_t j=firstListed; j<nListed; j++)
+			{
+				zr -= step.Z[j];
+				ar -= step.A[j];
+			}
+			if(zr < 0 || ar <= 0 || zr > ar)
+			{
+				m_isValid = false;
+				std::cerr << "Invalid parameters at ChainSystem::Init(), step " << i << " has no physical residual! Residual (Z,A): ("
+						  << zr << "," << ar << ")" << std::endl;
+				return;
+			}
+
+			Nucleus::ReactionRole productRole = isReaction ? Nucleus::ReactionRole::Ejectile : Nucleus::ReactionRole::Breakup1;
+			Nucleus::ReactionRole residRole = isReaction ? Nucleus::ReactionRole::Residual : Nucleus::ReactionRole::Breakup2;
+			slots.firstProduct = m_nuclei.size();
+			for(std::size_t j=firstListed; j<nListed; j++)
+				addNucleus(step.Z[j], step.A[j], productRole, i);
+			addNucleus(zr, ar, residRole, i);
+			slots.nProducts = m_nuclei.size() - slots.firstProduct;
+			stepSlots.push_back(slots);
+		}
+
+		//m_nuclei is final, so the steps can be bound to it
+		m_hasReaction = stepParams[0].rxnType == RxnType::Reaction;
+		m_steps.resize(stepParams.size());
+		for(std::size_t i=0; i<m_steps.size(); i++)
+		{
+			const StepSlots& slots = stepSlots[i];
+			ChainStep& step = m_steps[i];
+			step.type = stepParams[i].rxnType;
+			step.firstProduct = slots.firstProduct;
+			step.nProducts = slots.nProducts;
+			step.productMassSum = 0.0;
+			std::vector<double> masses;
+			for(std::size_t j=0; j<slots.nProducts; j++)
+			{
+				masses.push_back(m_nuclei[slots.firstProduct + j].groundStateMass);
+				step.productMassSum += masses.back();
+			}
+			if(step.type == RxnType::PhaseSpace)
+			{
+				step.phaseSpace = m_phaseSpaces.size();
+				m_phaseSpaces.emplace_back();
+				m_phaseSpaces.back().SetMasses(masses);
+			}
+			else
+			{
+				step.phaseSpace = s_noStep;
+				step.reaction.BindNuclei(&(m_nuclei[slots.target]), slots.projectile == s_noStep ? nullptr : &(m_nuclei[slots.projectile]),
+										 &(m_nuclei[slots.firstProduct]), &(m_nuclei[slots.firstProduct + 1]));
+			}
+			step.exLineshape = GetFullLineshape(stepParams[i]);
+			step.angularDistribution = stepParams[i].angularDistribution;
+			step.parentSlot = slots.target;
+			//Only a residual is left excited by the step that made it
+			std::size_t parentStep = slotStep[slots.target];
+			step.parentStep = (parentStep != s_noStep && stepSlots[parentStep].firstProduct + stepSlots[parentStep].nProducts - 1 == slots.target) ?
+							  parentStep : s_noStep;
+			step.theta = 0.0;
+			step.phi = 0.0;
+			step.ex = 0.0;
+		}
+		SetSystemEquation();
+		if(!InitLineshapes())
+			return;
+
+		if(!m_hasReaction)
+			return;
+		if(m_params.sampleBeam)
+			InitBeamTables(m_nuclei[1]);
+		else
+		{
+			m_beamTheta = 0.0; //A fixed beam is not straggled, see SampleParameters
+			m_rxnBeamEnergy = m_params.rxnBeamEnergy;
+			m_rxnPathLength = m_params.target.GetPathLength(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_rxnBeamEnergy);
+			m_beamStraggling = m_params.target.GetAngularStraggling(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_rxnPathLength);
+		}
+	}
+
+	/*
+		Lower limits run from the last step back: a residual must reach the lowest excitation its own decay can take. Upper
+		limits then run forward: a step can take no more than its parent's largest excitation (or the beam) leaves above its
+		products' ground states.
+	*/
+	bool ChainSystem::InitLineshapes()
+	{
+		const std::vector<StepParameters>& stepParams = m_params.stepParams;
+		std::vector<double> minEx(m_steps.size(), -std::numeric_limits<double>::infinity());
+		for(std::size_t i=m_steps.size(); i-- > 0;)
+		{
+			const ChainStep& step = m_steps[i];
+			if(step.parentStep == s_noStep)
+				continue;
+			double lowest = std::max(step.exLineshape.GetMinimum(), minEx[i]);
+			double needed = step.productMassSum + lowest - m_nuclei[step.parentSlot].groundStateMass;
+			minEx[step.parentStep] = std::max(minEx[step.parentStep], needed);
+		}
+
+		for(std::size_t i=0; i<m_steps.size(); i++)
+		{
+			ChainStep& step = m_steps[i];
+			double maxEx = 0.0;
+			if(i == 0 && m_hasReaction)
+				maxEx = step.reaction.GetMaxReactionExcitation(m_params.sampleBeam ? m_params.initialBeamEnergy : m_params.rxnBeamEnergy);
+			else
+			{
+				double parentEx = step.parentStep == s_noStep ? 0.0 : m_steps[step.parentStep].exLineshape.GetMaximum();
+				maxEx = m_nuclei[step.parentSlot].groundStateMass + parentEx - step.productMassSum;
+				if(step.type == RxnType::PhaseSpace)
+					maxEx -= PhaseSpaceDecay::s_thresholdMargin;
+			}
+			if(!InitLineshape(step.exLineshape, stepParams[i], minEx[i], maxEx))
+				return false;
+		}
+		return true;
+	}
+
+	//First step as for the one step (or decay) systems, then each decay as parent->products
+	void ChainSystem::SetSystemEquation()
+	{
+		std::stringstream stream;
+		if(m_hasReaction)
+		{
+			stream << GetIsotopicSymbol(m_nuclei[0]) << "("
+				   << GetIsotopicSymbol(m_nuclei[1]) << ", "
+				   << GetIsotopicSymbol(m_nuclei[2]) << ")"
+				   << GetIsotopicSymbol(m_nuclei[3]);
+		}
+		else
+		{
+			stream << GetIsotopicSymbol(m_nuclei[0]) << "->";
+			for(std::size_t j=0; j<m_steps[0].nProducts; j++)
+				stream << (j == 0 ? "" : "+") << GetIsotopicSymbol(m_nuclei[m_steps[0].firstProduct + j]);
+		}
+		for(std::size_t i=1; i<m_steps.size(); i++)
+		{
+			const ChainStep& step = m_steps[i];
+			stream << ", " << GetIsotopicSymbol(m_nuclei[step.parentSlot]) << "->";
+			for(std::size_t j=0; j<step.nProducts; j++)
+				stream << (j == 0 ? "" : "+") << GetIsotopicSymbol(m_nuclei[step.firstProduct + j]);
+		}
+		m_sysEquation = stream.str();
+	}
+
+	//Same draw order as TwoStepSystem: every two-body step's angles, every step's excitation, then the beam. Phase space
+	//steps draw their own angles when they are calculated
+	void ChainSystem::SampleParameters()
+	{
+		for(ChainStep& step : m_steps)
+		{
+			if(step.type == RxnType::PhaseSpace)
+				continue;
+			step.theta = step.angularDistribution.SampleTheta();
+			step.phi = RandomGenerator::GetUniformReal(s_phiMin, s_phiMax);
+		}
+		for(ChainStep& step : m_steps)
+			step.ex = step.exLineshape.Sample();
+
+		if(!m_hasReaction)
+			return;
+		m_beamPhi = RandomGenerator::GetUniformReal(s_phiMin, s_phiMax);
+		if(m_params.sampleBeam)
+		{
+			m_rxnBeamEnergy = RandomGenerator::GetUniformReal(0.0, m_params.initialBeamEnergy);
+			m_rxnPathLength = m_params.target.GetPathLength(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_rxnBeamEnergy);
+			m_beamStraggling = GetBeamStraggling(m_rxnPathLength);
+			m_beamTheta = RandomGenerator::GetUniformReal(0.0, m_beamStraggling);
+		}
+	}
+
+	bool ChainSystem::CheckThresholds()
+	{
+		for(std::size_t i=0; i<m_steps.size(); i++)
+		{
+			ChainStep& step = m_steps[i];
+			if(i == 0 && m_hasReaction)
+			{
+				if(!step.reaction.CheckReactionThreshold(m_rxnBeamEnergy, step.ex))
+					return false;
+			}
+			else
+			{
+				double parentEx = step.parentStep == s_noStep ? 0.0 : m_steps[step.parentStep].ex;
+				if(step.type == RxnType::PhaseSpace)
+				{
+					if(m_nuclei[step.parentSlot].groundStateMass + parentEx <= step.productMassSum + step.ex + PhaseSpaceDecay::s_thresholdMargin)
+						return false;
+				}
+				else if(!step.reaction.CheckDecayThreshold(parentEx, step.ex))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	//Products are generated in the parent rest frame and boosted with the parent; the residual carries the step excitation
+	bool ChainSystem::CalculatePhaseSpace(ChainStep& step)
+	{
+		PhaseSpaceDecay& phaseSpace = m_phaseSpaces[step.phaseSpace];
+		std::size_t residual = step.firstProduct + step.nProducts - 1;
+		phaseSpace.SetMass(step.nProducts - 1, m_nuclei[residual].groundStateMass + step.ex);
+
+		ROOT::Math::PxPyPzEVector parent = m_nuclei[step.parentSlot].GetVec4();
+		if(!phaseSpace.Generate(parent.M(), m_products))
+			return false;
+		ROOT::Math::Boost boost(parent.BoostToCM());
+		boost = boost.Inverse();
+		for(std::size_t j=0; j<step.nProducts; j++)
+			m_nuclei[step.firstProduct + j].SetVec4(boost * m_products[j]);
+		return true;
+	}
+
+	//Steps are in parent-first order, so each decay sees its parent's final four-vector
+	bool ChainSystem::CalculateSteps()
+	{
+		for(ChainStep& step : m_steps)
+		{
+			if(step.type == RxnType::PhaseSpace)
+			{
+				if(!CalculatePhaseSpace(step))
+					return false;
+				continue;
+			}
+			step.reaction.SetPolarRxnAngle(step.theta);
+			step.reaction.SetAzimRxnAngle(step.phi);
+			step.reaction.SetExcitation(step.ex);
+			step.reaction.Calculate();
+		}
+		return true;
+	}
+
+	void ChainSystem::RunSystem()
+	{
+		do
+		{
+			SampleParameters();
+			//Check to make sure that the sampled configuration is valid (energy is conserved) at every step
+			while(!CheckThresholds())
+			{
+				SampleParameters();
+			}
+
+			if(m_hasReaction)
+			{
+				Reaction& primary = m_steps[0].reaction;
+				primary.SetBeamKE(m_rxnBeamEnergy);
+				primary.SetBeamTheta(m_beamTheta);
+				primary.SetBeamPhi(m_beamPhi);
+			}
+		} while(!CalculateSteps());
+
+		if(!m_hasReaction)
+			return;
+		ROOT::Math::XYZPoint rxnPoint(std::sin(m_beamTheta)*std::cos(m_beamPhi)*m_rxnPathLength,
+									  std::sin(m_beamTheta)*std::sin(m_beamPhi)*m_rxnPathLength,
+									  std::cos(m_beamTheta)*m_rxnPathLength);
+		for(auto& nucleus : m_nuclei)
+			nucleus.SetRxnPoint(rxnPoint);
+	}
+
+}
@@ -0,0 +1,75 @@
+/*
+	ChainSystem.h
+	Generic sequential chain: an optional primary reaction followed by any number of decays, forming a tree. A decay is
+	either two-body (Decay) or N-body phase space (PhaseSpace, see PhaseSpaceDecay.h). Each decay step names its parent by
+	species; the parent is the first product of an earlier step with that (Z, A) which has not already decayed, taking a
+	step's residual (its last product) before its other products. Steps must be given parents first.
+
+	At Init the steps are flattened into a plan: every nucleus gets a fixed slot (target, projectile, ejectile, residual,
+	then the products of each decay in step order) and every step is bound to its slots, so an event is one pass over the
+	plan with no allocation. Only a product that a step leaves excited (a residual) carries its excitation into its own
+	decay; other products decay from their ground state. Each step's excitation lineshape is then limited to what its
+	parent can reach and what its own decay needs.
+*/
+#ifndef CHAINSYSTEM_H
+#define CHAINSYSTEM_H
+
+#include "ReactionSystem.h"
+#include "PhaseSpaceDecay.h"
+
+namespace AnasenSim {
+
+	class ChainSystem final : public ReactionSystem
+	{
+	public:
+		ChainSystem(const SystemParameters& params);
+		~ChainSystem();
+
+		void RunSystem();
+		const std::vector<NucleusRecord>& GetNuclei() const { return m_nuclei; }
+
+	private:
+		struct ChainStep
+		{
+			RxnType type;
+			Reaction reaction; //Reaction and Decay steps
+			std::size_t phaseSpace; //Index in m_phaseSpaces of a PhaseSpace step
+			std::size_t firstProduct; //Products occupy slots [firstProduct, firstProduct + nProducts), residual last
+			std::size_t nProducts;
+			double productMassSum; //Ground state masses, MeV
+			Lineshape exLineshape;
+			AngularDistribution angularDistribution;
+			std::size_t parentSlot; //Nucleus that decays (or the target of the reaction)
+			std::size_t parentStep; //Step whose residual excitation the parent carries; s_noStep if the parent is in its ground state
+			double theta; //Sampled per event
+			double phi;
+			double ex;
+		};
+
+		void Init();
+		bool InitLineshapes();
+		void SetSystemEquation();
+		void SampleParameters();
+		bool CheckThresholds();
+		//Returns false if the parent is below threshold after all; the event must then be resampled
+		bool CalculatePhaseSpace(ChainStep& step);
+		bool CalculateSteps();
+
+		std::vector<NucleusRecord> m_nuclei; //Sized once at Init; the steps hold pointers into it
+		std::vector<ChainStep> m_steps;
+		std::vector<PhaseSpaceDecay> m_phaseSpaces;
+		std::vector<ROOT::Math::PxPyPzEVector> m_products; //Phase space scratch
+		bool m_hasReaction;
+
+		double m_rxnPathLength;
+		double m_beamStraggling;
+		double m_rxnBeamEnergy;
+		double m_beamTheta;
+		double m_beamPhi;
+
+		static constexpr std::size_t s_noStep = ~std::size_t(0);
+	};
+
+}
+
+#endif
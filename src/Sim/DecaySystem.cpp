@@ -1,6 +1,7 @@
 #include "DecaySystem.h"
 #include "RandomGenerator.h"
 
+#include <limits>
 #include <sstream>
 
 namespace AnasenSim {
@@ -28,30 +29,31 @@ namespace AnasenSim {
 		int zr = step1Params.Z[0] - step1Params.Z[1];
 		int ar = step1Params.A[0] - step1Params.A[1];
 
-		m_nuclei.resize(3);
 		m_nuclei[0] = CreateNucleus(step1Params.Z[0], step1Params.A[0], Nucleus::ReactionRole::Target); //target
 		m_nuclei[1] = CreateNucleus(step1Params.Z[1], step1Params.A[1], Nucleus::ReactionRole::Breakup1); //breakup1
 		m_nuclei[2] = CreateNucleus(zr, ar, Nucleus::ReactionRole::Breakup2); //breakup2
 
 		m_step1.BindNuclei(&(m_nuclei[0]), nullptr, &(m_nuclei[1]), &(m_nuclei[2]));
 		SetSystemEquation();
+		InitLineshape(m_exLineshape, step1Params, -std::numeric_limits<double>::infinity(), m_step1.GetMaxDecayExcitation(0.0));
+		m_angularDistribution = step1Params.angularDistribution;
 		return;
 	}
 	
 	void DecaySystem::SetSystemEquation()
 	{
 		std::stringstream stream;
-		stream << m_nuclei[0].isotopicSymbol << "->"
-			   << m_nuclei[1].isotopicSymbol << "+"
-			   << m_nuclei[2].isotopicSymbol;
+		stream << GetIsotopicSymbol(m_nuclei[0]) << "->"
+			   << GetIsotopicSymbol(m_nuclei[1]) << "+"
+			   << GetIsotopicSymbol(m_nuclei[2]);
 		m_sysEquation = stream.str();
 	}
 
 	void DecaySystem::SampleParameters()
 	{
-		m_rxnTheta = std::acos(RandomGenerator::GetUniformReal(s_cosThetaMin, s_cosThetaMax));
+		m_rxnTheta = m_angularDistribution.SampleTheta();
 		m_rxnPhi = RandomGenerator::GetUniformReal(s_phiMin, s_phiMax);
-		m_ex = RandomGenerator::GetNormal(m_params.stepParams[0].meanResidualEx, m_params.stepParams[0].sigmaResidualEx);
+		m_ex = m_exLineshape.Sample();
 	}
 	
 	void DecaySystem::RunSystem()
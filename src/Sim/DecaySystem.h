@@ -5,23 +5,30 @@
 
 namespace AnasenSim {
 
-	class DecaySystem: public ReactionSystem
+	class DecaySystem final : public ReactionSystem
 	{
 	public:
+		static constexpr std::size_t s_nNuclei = 3;
+
 		DecaySystem(const SystemParameters& params);
 		~DecaySystem();
 	
-		virtual void RunSystem() override;
+		void RunSystem();
+		const std::array<NucleusRecord, s_nNuclei>& GetNuclei() const { return m_nuclei; }
 	
 	private:
 		void Init();
-		void SetSystemEquation() override;
+		void SetSystemEquation();
 		void SampleParameters();
+
+		std::array<NucleusRecord, s_nNuclei> m_nuclei;
 	
 		Reaction m_step1;
 		double m_rxnTheta;
 		double m_rxnPhi;
 		double m_ex;
+		Lineshape m_exLineshape;
+		AngularDistribution m_angularDistribution;
 	};
 
 }
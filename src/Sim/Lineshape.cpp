@@ -0,0 +1,313 @@
+#include "Lineshape.h"
+#include "RandomGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+namespace AnasenSim {
+
+	//Lines of numbers from a file, skipping blank and # lines
+	static bool ReadColumns(const std::string& filename, std::size_t nColumns, std::vector<std::vector<double>>& rows)
+	{
+		std::ifstream input(filename);
+		if(!input.is_open())
+		{
+			std::cerr << "Unable to open lineshape file " << filename << " at Lineshape!" << std::endl;
+			return false;
+		}
+
+		std::string line;
+		while(std::getline(input, line))
+		{
+			if(line.empty() || line[0] == '#')
+				continue;
+			std::stringstream lineStream(line);
+			std::vector<double> row(nColumns);
+			bool isRead = true;
+			for(double& value : row)
+				isRead = isRead && (lineStream >> value);
+			if(isRead)
+				rows.push_back(row);
+		}
+		return true;
+	}
+
+	Lineshape::Lineshape() :
+		m_type(Type::Normal), m_mean(0.0), m_sigma(0.0), m_width(0.0)
+	{
+	}
+
+	Lineshape::~Lineshape() {}
+
+	Lineshape::Type Lineshape::StringToType(const std::string& type)
+	{
+		if(type == "Gaussian")
+			return Type::Gaussian;
+		else if(type == "BreitWigner")
+			return Type::BreitWigner;
+		else if(type == "Table")
+			return Type::Table;
+		else if(type == "States")
+			return Type::States;
+		else
+			return Type::Normal;
+	}
+
+	bool Lineshape::ReadTable(const std::string& filename)
+	{
+		std::vector<std::vector<double>> rows;
+		if(!ReadColumns(filename, 2, rows))
+			return false;
+		std::sort(rows.begin(), rows.end());
+		if(rows.size() < 2 || std::any_of(rows.begin(), rows.end(), [](const std::vector<double>& row) { return row[1] < 0.0; }))
+		{
+			std::cerr << "Lineshape table " << filename << " needs at least two points, none below zero, at Lineshape::ReadTable!" << std::endl;
+			return false;
+		}
+
+		m_type = Type::Table;
+		m_tableEx.clear();
+		m_tableDensity.clear();
+		for(const std::vector<double>& row : rows)
+		{
+			m_tableEx.push_back(row[0]);
+			m_tableDensity.push_back(row[1]);
+		}
+		return true;
+	}
+
+	bool Lineshape::ReadStates(const std::string& filename)
+	{
+		std::vector<std::vector<double>> rows;
+		if(!ReadColumns(filename, 3, rows))
+			return false;
+		if(rows.empty() || std::any_of(rows.begin(), rows.end(), [](const std::vector<double>& row) { return row[1] < 0.0 || row[2] < 0.0; }))
+		{
+			std::cerr << "Lineshape states " << filename << " needs at least one state, with no negative sigma or ratio, at Lineshape::ReadStates!" << std::endl;
+			return false;
+		}
+
+		m_type = Type::States;
+		m_states.clear();
+		for(const std::vector<double>& row : rows)
+		{
+			Component state;
+			state.mean = row[0];
+			state.sigma = row[1];
+			state.ratio = row[2];
+			m_states.push_back(state);
+		}
+		return true;
+	}
+
+	void Lineshape::SetParameters(double mean, double sigma)
+	{
+		m_mean = mean;
+		m_sigma = sigma;
+
+		m_components.clear();
+		Component component;
+		component.mean = mean;
+		component.sigma = sigma;
+		component.ratio = 1.0;
+		switch(m_type)
+		{
+			case Type::Normal: return;
+			case Type::Gaussian: m_components.push_back(component); break;
+			case Type::BreitWigner:
+			{
+				component.sigma = m_width;
+				m_components.push_back(component);
+				break;
+			}
+			case Type::Table:
+			{
+				component.mean = 0.5 * (m_tableEx.front() + m_tableEx.back());
+				m_components.push_back(component);
+				break;
+			}
+			case Type::States: m_components = m_states; break;
+		}
+
+		for(Component& state : m_components)
+		{
+			double halfRange = 0.0;
+			if(m_type == Type::Table)
+				halfRange = 0.5 * (m_tableEx.back() - m_tableEx.front());
+			else
+				halfRange = (m_type == Type::BreitWigner ? s_nWidths : s_nSigmas) * state.sigma;
+			state.min = state.mean - halfRange;
+			state.max = state.mean + halfRange;
+		}
+		Truncate(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+	}
+
+	double Lineshape::GetMinimum() const
+	{
+		double minimum = std::numeric_limits<double>::infinity();
+		if(m_type == Type::Normal)
+			return m_sigma > 0.0 ? -minimum : m_mean;
+		for(const Component& component : m_components)
+		{
+			if(component.weight > 0.0)
+				minimum = std::min(minimum, component.min);
+		}
+		return minimum;
+	}
+
+	double Lineshape::GetMaximum() const
+	{
+		double maximum = -std::numeric_limits<double>::infinity();
+		if(m_type == Type::Normal)
+			return m_sigma > 0.0 ? -maximum : m_mean;
+		for(const Component& component : m_components)
+		{
+			if(component.weight > 0.0)
+				maximum = std::max(maximum, component.max);
+		}
+		return maximum;
+	}
+
+	double Lineshape::GetDensity(const Component& component, double ex) const
+	{
+		switch(m_type)
+		{
+			case Type::Normal: return 0.0;
+			case Type::Gaussian: case Type::States:
+			{
+				double x = (ex - component.mean) / component.sigma;
+				return std::exp(-0.5 * x * x) / (std::sqrt(2.0 * M_PI) * component.sigma);
+			}
+			case Type::BreitWigner:
+			{
+				double x = ex - component.mean;
+				return 0.5 * component.sigma / (M_PI * (x * x + 0.25 * component.sigma * component.sigma));
+			}
+			case Type::Table:
+			{
+				auto upper = std::upper_bound(m_tableEx.begin(), m_tableEx.end(), ex);
+				if(upper == m_tableEx.begin() || upper == m_tableEx.end())
+					return ex == m_tableEx.back() ? m_tableDensity.back() : 0.0;
+				std::size_t i = upper - m_tableEx.begin() - 1;
+				double fraction = (ex - m_tableEx[i]) / (m_tableEx[i + 1] - m_tableEx[i]);
+				return m_tableDensity[i] + fraction * (m_tableDensity[i + 1] - m_tableDensity[i]);
+			}
+		}
+		return 0.0;
+	}
+
+	/*
+		The density is integrated (trapezoid) on a uniform grid over the allowed part of the support. The guide table points
+		each of s_nGuide equal slices of probability at the grid interval where it starts, so a lookup only walks the few
+		intervals inside one slice, and the tails keep the resolution of the grid. weight is the integral times the branching
+		ratio; every state's density is normalized to 1 over its full support, so weights compare between states.
+	*/
+	void Lineshape::TabulateComponent(Component& component, double minEx, double maxEx) const
+	{
+		component.weight = 0.0;
+		component.cdf.clear();
+		component.guide.clear();
+		bool isSharp = m_type != Type::Table && component.sigma <= 0.0;
+		if(isSharp)
+		{
+			if(component.mean < minEx || component.mean > maxEx)
+				return;
+			component.min = component.max = component.mean;
+			component.weight = component.ratio;
+			return;
+		}
+
+		double low = std::max(component.min, minEx);
+		double high = std::min(component.max, maxEx);
+		if(!(high > low))
+			return;
+
+		double step = (high - low) / (s_nGrid - 1);
+		std::vector<double>& cdf = component.cdf;
+		cdf.assign(s_nGrid, 0.0);
+		double previousDensity = GetDensity(component, low);
+		for(std::size_t k=1; k<s_nGrid; k++)
+		{
+			double density = GetDensity(component, low + k * step);
+			cdf[k] = cdf[k - 1] + 0.5 * (density + previousDensity) * step;
+			previousDensity = density;
+		}
+		double integral = cdf.back();
+		if(!(integral > 0.0))
+		{
+			cdf.clear();
+			return;
+		}
+		for(double& value : cdf)
+			value /= integral;
+		cdf.back() = 1.0;
+
+		component.guide.resize(s_nGuide);
+		std::size_t k = 0;
+		for(std::size_t j=0; j<s_nGuide; j++)
+		{
+			double target = double(j) / s_nGuide;
+			while(k < s_nGrid - 2 && cdf[k + 1] <= target)
+				k++;
+			component.guide[j] = k;
+		}
+		component.min = low;
+		component.max = high;
+		component.weight = integral * component.ratio;
+	}
+
+	bool Lineshape::Truncate(double minEx, double maxEx)
+	{
+		if(m_type == Type::Normal)
+			return true;
+
+		double total = 0.0;
+		std::size_t last = 0; //Last component with any weight
+		for(std::size_t i=0; i<m_components.size(); i++)
+		{
+			TabulateComponent(m_components[i], minEx, maxEx);
+			total += m_components[i].weight;
+			m_components[i].cumulative = total;
+			if(m_components[i].weight > 0.0)
+				last = i;
+		}
+		if(!(total > 0.0))
+			return false;
+		//Rounding must not leave room to draw a component with no weight after the last allowed one
+		for(std::size_t i=0; i<m_components.size(); i++)
+			m_components[i].cumulative = i >= last ? 1.0 : m_components[i].cumulative / total;
+		return true;
+	}
+
+	double Lineshape::Sample() const
+	{
+		if(m_type == Type::Normal)
+			return RandomGenerator::GetNormal(m_mean, m_sigma);
+
+		//Pick the state with the draw, then reuse the draw's position within the state's share
+		double u = RandomGenerator::GetUniformFraction();
+		std::size_t index = 0;
+		while(index + 1 < m_components.size() && u >= m_components[index].cumulative)
+			index++;
+		const Component& component = m_components[index];
+		if(component.cdf.empty())
+			return component.mean;
+
+		double previous = index == 0 ? 0.0 : m_components[index - 1].cumulative;
+		double v = std::clamp((u - previous) / (component.cumulative - previous), 0.0, 1.0);
+		const std::vector<double>& cdf = component.cdf;
+		std::size_t k = component.guide[std::min(std::size_t(v * s_nGuide), s_nGuide - 1)];
+		while(k < s_nGrid - 2 && cdf[k + 1] <= v)
+			k++;
+		double width = cdf[k + 1] - cdf[k];
+		double fraction = width > 0.0 ? (v - cdf[k]) / width : 0.0;
+		double step = (component.max - component.min) / (s_nGrid - 1);
+		return component.min + (k + fraction) * step;
+	}
+
+}
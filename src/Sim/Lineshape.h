@@ -0,0 +1,97 @@
+/*
+	Lineshape.h
+	Distribution of a step's residual excitation energy. The default draws Normal(mean, sigma) exactly as before and leaves
+	anything outside the kinematic limits to the system's rejection loop. The other shapes are tabulated once, truncated to
+	the kinematic limits of the step, into cumulative tables with a guide table over them, so a sample is one uniform draw,
+	a guided lookup of a few table entries and a linear inversion:
+
+	Gaussian        Normal(mean, sigma), truncated
+	BreitWigner     Non-relativistic Breit-Wigner at mean with a fixed width (tails cut at s_nWidths widths)
+	Table           Density tabulated in a file, linear between points (e.g. an R-matrix shape with energy-dependent width)
+	States          Several states, each Normal(Ex, sigma) (sigma 0 for a sharp state), with branching ratios
+
+	A state (or the part of any shape) beyond the limits gets no weight, so the branching of States is renormalized over
+	what is kinematically allowed.
+
+	Table file: <Ex (MeV)> <density (any units)> per line. States file: <Ex (MeV)> <sigma (MeV)> <branching ratio> per line.
+	In both, # starts a comment line.
+*/
+#ifndef LINESHAPE_H
+#define LINESHAPE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AnasenSim {
+
+	class Lineshape
+	{
+	public:
+		enum class Type
+		{
+			Normal,
+			Gaussian,
+			BreitWigner,
+			Table,
+			States
+		};
+
+		Lineshape();
+		~Lineshape();
+
+		Type GetType() const { return m_type; }
+		void SetGaussian() { m_type = Type::Gaussian; }
+		void SetBreitWigner(double width) { m_type = Type::BreitWigner; m_width = width; }
+		//Return false, leaving the lineshape unchanged, if the file could not be read
+		bool ReadTable(const std::string& filename);
+		bool ReadStates(const std::string& filename);
+
+		//Mean and sigma of the step (used by Normal, Gaussian and the centroid of BreitWigner). Resets any truncation
+		void SetParameters(double mean, double sigma);
+		//Range the excitation can take, MeV: unbounded for Normal (unless sharp), the shape's support (or its truncation) otherwise
+		double GetMinimum() const;
+		double GetMaximum() const;
+		//Tabulate the shape limited to [minEx, maxEx]. Returns false if nothing of it is left
+		bool Truncate(double minEx, double maxEx);
+
+		double Sample() const;
+
+		static Type StringToType(const std::string& type);
+
+	private:
+		//One shape of the mixture; a sharp state has an empty table
+		struct Component
+		{
+			double mean = 0.0;
+			double sigma = 0.0; //Gaussian sigma or Breit-Wigner width, MeV
+			double ratio = 1.0;
+			double weight = 0.0; //Allowed share before normalization, 0 if truncated away
+			double cumulative = 0.0; //Normalized cumulative weight after truncation
+			double min = 0.0, max = 0.0; //Support, MeV
+			std::vector<double> cdf; //Normalized cumulative distribution at s_nGrid evenly spaced excitations from min to max
+			std::vector<uint32_t> guide; //guide[j]: last cdf point at or below probability j/s_nGuide
+		};
+
+		double GetDensity(const Component& component, double ex) const;
+		//Sets component.weight; min and max narrow to the allowed range
+		void TabulateComponent(Component& component, double minEx, double maxEx) const;
+
+		Type m_type;
+		double m_mean;
+		double m_sigma;
+		double m_width;
+		std::vector<double> m_tableEx; //Table shape
+		std::vector<double> m_tableDensity;
+		std::vector<Component> m_components; //Table, Gaussian and BreitWigner have one
+		std::vector<Component> m_states; //States as read, before SetParameters/Truncate
+
+		static constexpr std::size_t s_nGrid = 4096; //Density points per component when integrating the CDF
+		static constexpr std::size_t s_nGuide = 1024; //Intervals of the guide table
+		static constexpr double s_nSigmas = 8.0; //Gaussian support
+		static constexpr double s_nWidths = 50.0; //Breit-Wigner support
+	};
+
+}
+
+#endif
@@ -0,0 +1,35 @@
+#include "MassFile.h"
+
+#include <fstream>
+#include <iostream>
+
+namespace AnasenSim {
+
+	bool ReadMassFile(const std::string& filename, std::vector<MassFileEntry>& entries)
+	{
+		std::ifstream massfile(filename);
+		if(!massfile.is_open())
+		{
+			std::cerr << "Unable to open mass file " << filename << " at ReadMassFile!" << std::endl;
+			return false;
+		}
+
+		std::string junk;
+		MassFileEntry entry;
+		entries.clear();
+		getline(massfile,junk);
+		getline(massfile,junk);
+		while(massfile>>junk)
+		{
+			massfile>>entry.Z>>entry.A>>entry.element>>entry.atomicMassU>>entry.atomicMassMicroU;
+			entries.push_back(entry);
+		}
+		if(entries.empty())
+		{
+			std::cerr << "Mass file " << filename << " has no entries at ReadMassFile!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+}
@@ -0,0 +1,33 @@
+/*
+	MassFile.h
+	Parser for mass files in the AME format of etc/mass.txt: two header lines, then one isotope per line as
+	N Z A element mass(u) mass(micro-u). Shared by MassLookup::LoadFile (a MassFile override at run time) and
+	MassTableGenerator (the compiled-in MassTable.h), so both read a file the same way. It does not depend on MassTable.h,
+	which the generator has to be built without.
+*/
+#ifndef MASS_FILE_H
+#define MASS_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AnasenSim {
+
+	//One line of a mass file. The masses are kept as written, so the generator can copy them into MassTable.h verbatim
+	struct MassFileEntry
+	{
+		uint32_t Z = 0;
+		uint32_t A = 0;
+		std::string element;
+		std::string atomicMassU; //Integer part, u
+		std::string atomicMassMicroU; //Remainder, micro-u
+	};
+
+	//Entries in file order (a later line for the same isotope replaces an earlier one for both users). Returns false if
+	//the file could not be opened or has no entries
+	bool ReadMassFile(const std::string& filename, std::vector<MassFileEntry>& entries);
+
+}
+
+#endif
@@ -1,61 +1,121 @@
 /*
 
-MassLookup.h
-Generates a map for isotopic masses using AMDC data; subtracts away
-electron mass from the atomic mass by default. Creates a static global instance
-of this map (MASS) for use throughout code it is included into.
+MassLookup.cpp
+Lookups index the compiled-in table (MassTable.h) directly by (Z, A). LoadFile rebuilds the same layout from a mass file.
 
 Written by G.W. McCann Aug. 2020
 
 */
 #include "MassLookup.h"
-#include <sstream>
-#include "Utils/UUID.h"
+#include "MassTable.h"
+#include "MassFile.h"
+
+#include <map>
 
 namespace AnasenSim {
 
-	MassLookup* MassLookup::s_instance = new MassLookup();
+	MassLookup& MassLookup::GetInstance()
+	{
+		static MassLookup s_instance;
+		return s_instance;
+	}
 
 	MassLookup::MassLookup()
 	{
-		std::ifstream massfile("etc/mass.txt");
-		if(massfile.is_open())
+		UseEmbeddedTable();
+	}
+	
+	MassLookup::~MassLookup() {}
+
+	void MassLookup::UseEmbeddedTable()
+	{
+		m_ranges = s_elementRanges;
+		m_nElements = sizeof(s_elementRanges) / sizeof(s_elementRanges[0]);
+		m_table = s_massTable;
+		m_fileRanges.clear();
+		m_fileTable.clear();
+		m_fileSymbols.clear();
+	}
+
+	//Same layout as MassTable.h: ordered by Z then A, with placeholders for isotopes missing from the file
+	bool MassLookup::LoadFile(const std::string& filename)
+	{
+		std::vector<MassFileEntry> entries;
+		if(!ReadMassFile(filename, entries))
+			return false;
+
+		std::map<std::pair<uint32_t, uint32_t>, std::pair<double, std::string>> isotopes;
+		for(const MassFileEntry& entry : entries)
 		{
-			std::string junk, element;
-			double atomicMassBig, atomicMassSmall, isotopicMass;
-			getline(massfile,junk);
-			getline(massfile,junk);
-			NucData data;
-			while(massfile>>junk)
+			double mass = GetIsotopicMass(entry.Z, std::stod(entry.atomicMassU), std::stod(entry.atomicMassMicroU));
+			isotopes[{entry.Z, entry.A}] = {mass, std::to_string(entry.A) + entry.element};
+		}
+
+		std::vector<ElementRange> ranges(isotopes.rbegin()->first.first + 1, ElementRange{0, 1, 0});
+		for(const auto& isotope : isotopes)
+		{
+			ElementRange& range = ranges[isotope.first.first];
+			if(range.aMin > range.aMax)
+				range.aMin = isotope.first.second;
+			range.aMax = isotope.first.second;
+		}
+
+		std::vector<NucData> table;
+		std::deque<std::string> symbols;
+		for(uint32_t i=0; i<ranges.size(); i++)
+		{
+			ranges[i].offset = table.size();
+			for(uint32_t j=ranges[i].aMin; j<=ranges[i].aMax; j++)
 			{
-				massfile>>data.Z>>data.A>>element>>atomicMassBig>>atomicMassSmall;
-				data.isotopicMass = (atomicMassBig + atomicMassSmall*1e-6 - data.Z*s_electronMass)*s_u2MeV;
-				data.isotopicSymbol = std::to_string(data.A) + element;
-				m_dataMap[GetUUID(data.Z, data.A)] = data;
+				auto iter = isotopes.find({i, j});
+				if(iter == isotopes.end())
+					table.push_back({nullptr, s_invalidMass, uint16_t(i), uint16_t(j)});
+				else
+				{
+					symbols.push_back(iter->second.second);
+					table.push_back({symbols.back().c_str(), iter->second.first, uint16_t(i), uint16_t(j)});
+				}
 			}
 		}
+
+		m_fileRanges = std::move(ranges);
+		m_fileTable = std::move(table);
+		m_fileSymbols = std::move(symbols);
+		m_ranges = m_fileRanges.data();
+		m_nElements = m_fileRanges.size();
+		m_table = m_fileTable.data();
+		return true;
+	}
+
+	const MassLookup::NucData* MassLookup::Find(uint32_t Z, uint32_t A) const
+	{
+		if(Z >= m_nElements)
+			return nullptr;
+		const ElementRange& range = m_ranges[Z];
+		if(A < range.aMin || A > range.aMax)
+			return nullptr;
+		const NucData* data = &m_table[range.offset + A - range.aMin];
+		return data->isotopicSymbol == nullptr ? nullptr : data;
 	}
-	
-	MassLookup::~MassLookup() {}
 	
 	//Returns nuclear mass in MeV
-	double MassLookup::FindMass(uint32_t Z, uint32_t A)
+	double MassLookup::FindMass(uint32_t Z, uint32_t A) const
 	{
-		auto data = m_dataMap.find(GetUUID(Z, A));
-		if(data == m_dataMap.end())
+		const NucData* data = Find(Z, A);
+		if(data == nullptr)
 			return s_invalidMass;
 	
-		return data->second.isotopicMass;
+		return data->isotopicMass;
 	}
 	
-	//returns element symbol
-	std::string MassLookup::FindSymbol(uint32_t Z, uint32_t A)
+	//returns isotopic symbol (e.g. 7Be)
+	std::string_view MassLookup::FindSymbol(uint32_t Z, uint32_t A) const
 	{
-		auto data = m_dataMap.find(GetUUID(Z, A));
-		if(data == m_dataMap.end())
+		const NucData* data = Find(Z, A);
+		if(data == nullptr)
 			return s_invalidSymbol;
 	
-		return data->second.isotopicSymbol;
+		return data->isotopicSymbol;
 	}
 
-}
\ No newline at end of file
+}
@@ -1,9 +1,10 @@
 /*
 
 MassLookup.h
-Generates a map for isotopic masses using AMDC data; subtracts away
-electron mass from the atomic mass by default. Creates a static global instance
-of this map (MASS) for use throughout code it is included into.
+Isotopic masses from the AME atomic mass evaluation, with the electron masses subtracted away from the atomic masses.
+The evaluation is compiled in (MassTable.h, written from etc/mass.txt by MassTableGenerator at build time), so no file is read at
+startup and lookups are a direct index by (Z, A).
+A different evaluation in the etc/mass.txt format can be loaded in its place with LoadFile.
 
 Written by G.W. McCann Aug. 2020
 
@@ -12,9 +13,11 @@ Converted to true singleton to simplify usage -- Aug. 2021 GWM
 #ifndef MASS_LOOKUP_H
 #define MASS_LOOKUP_H
 
-#include <fstream>
+#include <cstdint>
+#include <deque>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 namespace AnasenSim {
 
@@ -24,31 +27,57 @@ namespace AnasenSim {
 
 		struct NucData
 		{
-			std::string isotopicSymbol;
-			double isotopicMass;
-			uint32_t Z;
-			uint32_t A;
+			const char* isotopicSymbol; //nullptr if the isotope is not in the table
+			double isotopicMass; //MeV
+			uint16_t Z;
+			uint16_t A;
+		};
+
+		//Isotopes of one element occupy table entries [offset, offset + aMax - aMin]
+		struct ElementRange
+		{
+			uint32_t offset;
+			uint16_t aMin;
+			uint16_t aMax;
 		};
 
 		~MassLookup();
-		double FindMass(uint32_t Z, uint32_t A);
-		double FindMassU(uint32_t Z, uint32_t A) { return FindMass(Z, A)/s_u2MeV; }
-		std::string FindSymbol(uint32_t Z, uint32_t A);
+		double FindMass(uint32_t Z, uint32_t A) const;
+		double FindMassU(uint32_t Z, uint32_t A) const { return FindMass(Z, A)/s_u2MeV; }
+		std::string_view FindSymbol(uint32_t Z, uint32_t A) const;
+
+		//Replace the compiled-in masses with those of a mass file. Not thread safe: load before any simulation starts
+		bool LoadFile(const std::string& filename);
+		void UseEmbeddedTable();
 	
-		static bool IsInvalidSymbol(const std::string& symbol) { return symbol == s_invalidSymbol; }
+		static bool IsInvalidSymbol(std::string_view symbol) { return symbol == s_invalidSymbol; }
 		static bool IsInvalidMass(double mass) { return mass == s_invalidMass; }
-		static MassLookup& GetInstance() { return *s_instance; }
+		static MassLookup& GetInstance();
+
+		//atomicMassU and atomicMassMicroU are the whole and micro-u parts of the atomic mass as listed in the evaluation
+		static constexpr double GetIsotopicMass(uint32_t Z, double atomicMassU, double atomicMassMicroU)
+		{
+			return (atomicMassU + atomicMassMicroU*1e-6 - Z*s_electronMass)*s_u2MeV;
+		}
+
+		static constexpr double s_invalidMass = -1.0; //MeV
 	
 	private:
 		MassLookup();
+		const NucData* Find(uint32_t Z, uint32_t A) const;
 
-		static MassLookup* s_instance;
+		//Current table, either the compiled-in one or the file storage below
+		const ElementRange* m_ranges;
+		std::size_t m_nElements;
+		const NucData* m_table;
+
+		std::vector<ElementRange> m_fileRanges;
+		std::vector<NucData> m_fileTable;
+		std::deque<std::string> m_fileSymbols; //deque so symbol pointers stay valid as it grows
 
-		std::unordered_map<uint32_t, NucData> m_dataMap;
 		//constants
 		static constexpr double s_u2MeV = 931.4940954;
 		static constexpr double s_electronMass = 0.000548579909;
-		static constexpr double s_invalidMass = -1.0; //MeV
 		static constexpr char s_invalidSymbol[] = "Invalid";
 
 	};
@@ -0,0 +1,106 @@
+/*
+	NucleusRecord.h
+	Working form of a nucleus for generation and detection. Nucleus (Dict/Nucleus.h) is the persisted ROOT class and carries
+	strings and GenVector objects; NucleusRecord holds the same values as plain numbers so it is trivially copyable and
+	an event is a flat array. Everything generation writes and detection reads to trace a trajectory is in the first 64 bytes
+	of the record, the detector response in the next 64 (a cache line's worth each; records are not aligned to cache lines, so
+	an event stays densely packed). Records are converted to Nucleus only when an event is written (see SimBase.h).
+*/
+#ifndef NUCLEUS_RECORD_H
+#define NUCLEUS_RECORD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
+#include "Math/Vector4D.h"
+#include "Math/Point3D.h"
+#include "Dict/Nucleus.h"
+
+namespace AnasenSim {
+
+	enum class SiliconDetector : uint8_t
+	{
+		None,
+		Barrel1,
+		Barrel2,
+		FQQQ
+	};
+
+	//Name written to Nucleus::siDetectorName
+	static constexpr const char* SiliconDetectorToString(SiliconDetector detector)
+	{
+		switch(detector)
+		{
+			case SiliconDetector::None: return "";
+			case SiliconDetector::Barrel1: return "R1";
+			case SiliconDetector::Barrel2: return "R2";
+			case SiliconDetector::FQQQ: return "FQQQ";
+		}
+		return "";
+	}
+
+	struct NucleusRecord
+	{
+		ROOT::Math::PxPyPzEVector GetVec4() const { return ROOT::Math::PxPyPzEVector(px, py, pz, E); }
+		void SetVec4(const ROOT::Math::PxPyPzEVector& vec4)
+		{
+			px = vec4.Px();
+			py = vec4.Py();
+			pz = vec4.Pz();
+			E = vec4.E();
+		}
+
+		void SetVec4Spherical(double theta, double phi, double p, double energy)
+		{
+			px = std::sin(theta)*std::cos(phi)*p;
+			py = std::sin(theta)*std::sin(phi)*p;
+			pz = std::cos(theta)*p;
+			E = energy;
+		}
+
+		double GetKE() const //MeV
+		{
+			ROOT::Math::PxPyPzEVector vec4 = GetVec4();
+			return vec4.E() - vec4.M();
+		}
+
+		double GetExcitationEnergy() const //MeV
+		{
+			return GetVec4().M() - groundStateMass;
+		}
+
+		ROOT::Math::XYZPoint GetRxnPoint() const { return ROOT::Math::XYZPoint(rxnX, rxnY, rxnZ); }
+		void SetRxnPoint(const ROOT::Math::XYZPoint& point) { rxnX = point.X(); rxnY = point.Y(); rxnZ = point.Z(); }
+		ROOT::Math::XYZPoint GetSiVector() const { return ROOT::Math::XYZPoint(siX, siY, siZ); }
+		void SetSiVector(const ROOT::Math::XYZPoint& point) { siX = point.X(); siY = point.Y(); siZ = point.Z(); }
+		ROOT::Math::XYZPoint GetPCVector() const { return ROOT::Math::XYZPoint(pcX, pcY, pcZ); }
+		void SetPCVector(const ROOT::Math::XYZPoint& point) { pcX = point.X(); pcY = point.Y(); pcZ = point.Z(); }
+
+		//Kinematics and species
+		double px = 0.0, py = 0.0, pz = 0.0, E = 0.0; //MeV
+		double rxnX = 0.0, rxnY = 0.0, rxnZ = 0.0; //m
+		uint16_t Z = 0;
+		uint16_t A = 0;
+		Nucleus::ReactionRole role = Nucleus::ReactionRole::None;
+
+		//Detector response
+		double siliconDetKE = 0.0; //MeV
+		double siX = 0.0, siY = 0.0, siZ = 0.0; //m
+		double pcDetE = 0.0; //MeV
+		double pcX = 0.0, pcY = 0.0, pcZ = 0.0; //m
+
+		double groundStateMass = 0.0; //MeV
+		double thetaCM = 0.0; //rad
+		bool isDetected = false;
+		SiliconDetector siDetector = SiliconDetector::None;
+		uint16_t step = 0; //Step of the chain that produced the nucleus (see Nucleus::step)
+	};
+
+	static_assert(std::is_trivially_copyable_v<NucleusRecord>, "NucleusRecord must stay trivially copyable");
+	static_assert(offsetof(NucleusRecord, siliconDetKE) == 64, "NucleusRecord kinematics and species should take the first 64 bytes");
+	static_assert(offsetof(NucleusRecord, groundStateMass) == 128, "NucleusRecord detector response should take the next 64 bytes");
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "OneStepSystem.h"
 #include "RandomGenerator.h"
 
+#include <limits>
 #include <sstream>
 
 namespace AnasenSim {
@@ -30,7 +31,6 @@ namespace AnasenSim {
 		int zr = step1Params.Z[0] + step1Params.Z[1] - step1Params.Z[2];
 		int ar = step1Params.A[0] + step1Params.A[1] - step1Params.A[2];
 
-		m_nuclei.resize(4);
 		m_nuclei[0] = CreateNucleus(step1Params.Z[0], step1Params.A[0], Nucleus::ReactionRole::Target); //target
 		m_nuclei[1] = CreateNucleus(step1Params.Z[1], step1Params.A[1], Nucleus::ReactionRole::Projectile); //projectile
 		m_nuclei[2] = CreateNucleus(step1Params.Z[2], step1Params.A[2], Nucleus::ReactionRole::Ejectile); //ejectile
@@ -38,8 +38,14 @@ namespace AnasenSim {
 
 		m_step1.BindNuclei(&(m_nuclei[0]), &(m_nuclei[1]), &(m_nuclei[2]), &(m_nuclei[3]));
 		SetSystemEquation();
+		//A sampled beam can react at any energy up to the initial one
+		double maxBeamEnergy = m_params.sampleBeam ? m_params.initialBeamEnergy : m_params.rxnBeamEnergy;
+		InitLineshape(m_residExLineshape, step1Params, -std::numeric_limits<double>::infinity(), m_step1.GetMaxReactionExcitation(maxBeamEnergy));
+		m_angularDistribution = step1Params.angularDistribution;
 
-		if(!m_params.sampleBeam)
+		if(m_params.sampleBeam)
+			InitBeamTables(m_nuclei[1]);
+		else
 		{
 			m_rxnBeamEnergy = m_params.rxnBeamEnergy;
 			m_rxnPathLength = m_params.target.GetPathLength(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_rxnBeamEnergy);
@@ -51,23 +57,23 @@ namespace AnasenSim {
 	void OneStepSystem::SetSystemEquation()
 	{
 		std::stringstream stream;
-		stream << m_nuclei[0].isotopicSymbol << "("
-			   << m_nuclei[1].isotopicSymbol << ", "
-			   << m_nuclei[2].isotopicSymbol << ")"
-			   << m_nuclei[3].isotopicSymbol;
+		stream << GetIsotopicSymbol(m_nuclei[0]) << "("
+			   << GetIsotopicSymbol(m_nuclei[1]) << ", "
+			   << GetIsotopicSymbol(m_nuclei[2]) << ")"
+			   << GetIsotopicSymbol(m_nuclei[3]);
 		m_sysEquation = stream.str();
 	}
 
 	void OneStepSystem::SampleParameters()
 	{
-		m_rxnTheta = std::acos(RandomGenerator::GetUniformReal(s_cosThetaMin, s_cosThetaMax));
+		m_rxnTheta = m_angularDistribution.SampleTheta();
 		m_rxnPhi = RandomGenerator::GetUniformReal(s_phiMin, s_phiMax);
-		m_residEx = RandomGenerator::GetNormal(m_params.stepParams[0].meanResidualEx, m_params.stepParams[0].sigmaResidualEx);
+		m_residEx = m_residExLineshape.Sample();
 		if(m_params.sampleBeam)
 		{
 			m_rxnBeamEnergy = RandomGenerator::GetUniformReal(0.0, m_params.initialBeamEnergy);
-			m_rxnPathLength = m_params.target.GetPathLength(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_params.rxnBeamEnergy);
-			m_beamStraggling = m_params.target.GetAngularStraggling(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_rxnPathLength);
+			m_rxnPathLength = m_params.target.GetPathLength(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_rxnBeamEnergy);
+			m_beamStraggling = GetBeamStraggling(m_rxnPathLength);
 		}
 		m_beamTheta = RandomGenerator::GetUniformReal(0.0, m_beamStraggling);
 		m_beamPhi = RandomGenerator::GetUniformReal(s_phiMin, s_phiMax);
@@ -76,7 +82,7 @@ namespace AnasenSim {
 	void OneStepSystem::RunSystem()
 	{
 		
-		static ROOT::Math::XYZPoint rxnPoint;
+		ROOT::Math::XYZPoint rxnPoint;
 
 		SampleParameters();
 		while(!m_step1.CheckReactionThreshold(m_rxnBeamEnergy, m_residEx))
@@ -99,7 +105,7 @@ namespace AnasenSim {
 		m_step1.Calculate();
 
 		for(auto& nucleus : m_nuclei)
-			nucleus.rxnPoint = rxnPoint;
+			nucleus.SetRxnPoint(rxnPoint);
 	}
 
 }
\ No newline at end of file
@@ -5,25 +5,32 @@
 
 namespace AnasenSim {
 
-	class OneStepSystem: public ReactionSystem
+	class OneStepSystem final : public ReactionSystem
 	{
 	public:
+		static constexpr std::size_t s_nNuclei = 4;
+
 		OneStepSystem(const SystemParameters& params);
 		~OneStepSystem();
 	
-		void RunSystem() override;
+		void RunSystem();
+		const std::array<NucleusRecord, s_nNuclei>& GetNuclei() const { return m_nuclei; }
 	
 	private:
 		void Init();
-		virtual void SetSystemEquation() override;
+		void SetSystemEquation();
 		void SampleParameters();
 
+		std::array<NucleusRecord, s_nNuclei> m_nuclei;
+
 		double m_rxnPathLength;
 		double m_beamStraggling;
 		double m_rxnBeamEnergy;
 		double m_rxnTheta;
 		double m_rxnPhi;
 		double m_residEx;
+		Lineshape m_residExLineshape;
+		AngularDistribution m_angularDistribution;
 		double m_beamTheta;
 		double m_beamPhi;
 			
@@ -0,0 +1,158 @@
+#include "PhaseSpaceDecay.h"
+#include "RandomGenerator.h"
+
+#include "Math/Boost.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace AnasenSim {
+
+	PhaseSpaceDecay::PhaseSpaceDecay()
+	{
+		m_weights.fill(0.0);
+	}
+
+	PhaseSpaceDecay::~PhaseSpaceDecay() {}
+
+	void PhaseSpaceDecay::SetMasses(const std::vector<double>& masses)
+	{
+		m_masses = masses;
+		m_invariantMass.resize(m_masses.size() * s_batchSize);
+		m_momentum.resize(m_masses.size() * s_batchSize);
+		m_fractions.resize(m_masses.size() * s_batchSize);
+	}
+
+	double PhaseSpaceDecay::GetMassSum() const
+	{
+		return std::accumulate(m_masses.begin(), m_masses.end(), 0.0);
+	}
+
+	//Momentum of either product in the rest frame of the parent; 0 below threshold
+	double PhaseSpaceDecay::GetBreakupMomentum(double parentMass, double mass1, double mass2)
+	{
+		double sum = mass1 + mass2;
+		double diff = mass1 - mass2;
+		double p2 = (parentMass - sum) * (parentMass + sum) * (parentMass - diff) * (parentMass + diff);
+		return p2 > 0.0 ? std::sqrt(p2) / (2.0 * parentMass) : 0.0;
+	}
+
+	/*
+		For products 0..N-1 and kinetic energy T = M - sum(m), the mass of subsystem (0..k) is sum(m_0..m_k) + r_k*T, with
+		r_0 = 0, r_{N-1} = 1 and r_1..r_{N-2} sorted uniform numbers. The weight is the product over k of the breakup momentum of
+		subsystem k into subsystem k-1 and product k, divided by its value with all of T given to each breakup in turn (the
+		GENBOD maximum).
+	*/
+	const std::array<double, PhaseSpaceDecay::s_batchSize>& PhaseSpaceDecay::GenerateBatch(double parentMass)
+	{
+		const std::size_t nProducts = m_masses.size();
+		const double kineticEnergy = parentMass - GetMassSum();
+		if(nProducts < 2 || kineticEnergy <= 0.0)
+		{
+			m_weights.fill(0.0);
+			return m_weights;
+		}
+
+		for(std::size_t i=0; i<s_batchSize; i++)
+		{
+			double* fractions = &m_fractions[i * nProducts];
+			fractions[0] = 0.0;
+			for(std::size_t k=1; k<nProducts-1; k++)
+				fractions[k] = RandomGenerator::GetUniformFraction();
+			fractions[nProducts - 1] = 1.0;
+			std::sort(fractions + 1, fractions + nProducts - 1);
+		}
+
+		double massSum = 0.0;
+		for(std::size_t k=0; k<nProducts; k++)
+		{
+			massSum += m_masses[k];
+			double* invariantMass = &m_invariantMass[k * s_batchSize];
+			for(std::size_t i=0; i<s_batchSize; i++)
+				invariantMass[i] = massSum + m_fractions[i * nProducts + k] * kineticEnergy;
+		}
+
+		double maxWeight = 1.0;
+		double minMass = 0.0;
+		double maxMass = kineticEnergy + m_masses[0];
+		m_weights.fill(1.0);
+		for(std::size_t k=1; k<nProducts; k++)
+		{
+			minMass += m_masses[k - 1];
+			maxMass += m_masses[k];
+			maxWeight *= GetBreakupMomentum(maxMass, minMass, m_masses[k]);
+
+			const double* invariantMass = &m_invariantMass[k * s_batchSize];
+			const double* subMass = &m_invariantMass[(k - 1) * s_batchSize];
+			double* momentum = &m_momentum[k * s_batchSize];
+			const double mass = m_masses[k];
+			for(std::size_t i=0; i<s_batchSize; i++)
+			{
+				double sum = subMass[i] + mass;
+				double diff = subMass[i] - mass;
+				double p2 = (invariantMass[i] - sum) * (invariantMass[i] + sum) * (invariantMass[i] - diff) * (invariantMass[i] + diff);
+				momentum[i] = std::sqrt(std::max(p2, 0.0)) / (2.0 * invariantMass[i]);
+				m_weights[i] *= momentum[i];
+			}
+		}
+
+		const double norm = maxWeight > 0.0 ? 1.0 / maxWeight : 0.0;
+		for(std::size_t i=0; i<s_batchSize; i++)
+			m_weights[i] *= norm;
+		return m_weights;
+	}
+
+	bool PhaseSpaceDecay::Generate(double parentMass, std::vector<ROOT::Math::PxPyPzEVector>& products)
+	{
+		if(m_masses.size() < 2 || parentMass <= GetMassSum() + s_thresholdMargin)
+			return false;
+
+		while(true)
+		{
+			const std::array<double, s_batchSize>& weights = GenerateBatch(parentMass);
+			for(std::size_t i=0; i<s_batchSize; i++)
+			{
+				if(RandomGenerator::GetUniformFraction() < weights[i])
+				{
+					BuildProducts(i, products);
+					return true;
+				}
+			}
+		}
+	}
+
+	/*
+		Products 0 and 1 break up back to back in the frame of subsystem 1. Each following product k is emitted against
+		subsystem k-1 in the frame of subsystem k, and products 0..k-1 are boosted along with their subsystem, so the last
+		frame is the parent rest frame. Directions are isotropic in each frame.
+	*/
+	void PhaseSpaceDecay::BuildProducts(std::size_t candidate, std::vector<ROOT::Math::PxPyPzEVector>& products) const
+	{
+		const std::size_t nProducts = m_masses.size();
+		products.resize(nProducts);
+		for(std::size_t k=1; k<nProducts; k++)
+		{
+			double p = m_momentum[k * s_batchSize + candidate];
+			double cosTheta = RandomGenerator::GetUniformReal(-1.0, 1.0);
+			double sinTheta = std::sqrt(1.0 - cosTheta * cosTheta);
+			double phi = RandomGenerator::GetUniformReal(0.0, 2.0 * M_PI);
+			double nx = sinTheta * std::cos(phi);
+			double ny = sinTheta * std::sin(phi);
+			double nz = cosTheta;
+
+			products[k].SetPxPyPzE(p * nx, p * ny, p * nz, std::sqrt(p * p + m_masses[k] * m_masses[k]));
+			if(k == 1)
+			{
+				products[0].SetPxPyPzE(-p * nx, -p * ny, -p * nz, std::sqrt(p * p + m_masses[0] * m_masses[0]));
+				continue;
+			}
+
+			double subMass = m_invariantMass[(k - 1) * s_batchSize + candidate];
+			double subEnergy = std::sqrt(p * p + subMass * subMass);
+			ROOT::Math::Boost boost(-p * nx / subEnergy, -p * ny / subEnergy, -p * nz / subEnergy);
+			for(std::size_t j=0; j<k; j++)
+				products[j] = boost * products[j];
+		}
+	}
+
+}
@@ -0,0 +1,61 @@
+/*
+	PhaseSpaceDecay.h
+	N-body phase space decay of a nucleus at rest, sampled with the GENBOD method (F. James, CERN 68-15): the N-2
+	intermediate invariant masses come from sorted uniform numbers, and the configuration weight is the product of the
+	two-body breakup momenta, normalized by its maximum so it lies in [0, 1].
+
+	Candidates are weighted in batches laid out by invariant mass index, so the weight loops run over the batch and
+	vectorize. GenerateBatch exposes the weighted candidates directly; Generate returns unweighted events by
+	accept/reject over the batch, and only builds four-vectors for the accepted candidate.
+*/
+#ifndef PHASE_SPACE_DECAY_H
+#define PHASE_SPACE_DECAY_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "Math/Vector4D.h"
+
+namespace AnasenSim {
+
+	class PhaseSpaceDecay
+	{
+	public:
+		static constexpr std::size_t s_batchSize = 16;
+		//A parent must exceed the product masses by more than this (MeV). Callers checking thresholds use the same test, so
+		//a parent mass rebuilt from a boosted four-vector cannot round below what they accepted
+		static constexpr double s_thresholdMargin = 1.0e-6;
+
+		PhaseSpaceDecay();
+		~PhaseSpaceDecay();
+
+		//Product masses in MeV, at least two products
+		void SetMasses(const std::vector<double>& masses);
+		//Change the mass of one product (e.g. to add an excitation) without reallocating
+		void SetMass(std::size_t product, double mass) { m_masses[product] = mass; }
+		std::size_t GetNumberOfProducts() const { return m_masses.size(); }
+		double GetMassSum() const;
+
+		//Weights (relative to the maximum) of a batch of s_batchSize candidates for a parent of the given mass (MeV)
+		const std::array<double, s_batchSize>& GenerateBatch(double parentMass);
+		//One unweighted event; products holds the four-vectors in the parent rest frame, in product order.
+		//Returns false (products unchanged) if the parent is not above threshold by s_thresholdMargin
+		bool Generate(double parentMass, std::vector<ROOT::Math::PxPyPzEVector>& products);
+
+	private:
+		static double GetBreakupMomentum(double parentMass, double mass1, double mass2);
+		//Four-vectors of candidate i of the current batch
+		void BuildProducts(std::size_t candidate, std::vector<ROOT::Math::PxPyPzEVector>& products) const;
+
+		std::vector<double> m_masses;
+		//Batch scratch: m_invariantMass[k*s_batchSize + i] is the mass of products 0..k of candidate i, likewise m_momentum for
+		//the breakup momentum of that subsystem into (0..k-1) + k
+		std::vector<double> m_invariantMass;
+		std::vector<double> m_momentum;
+		std::vector<double> m_fractions; //Sorted uniform numbers of each candidate
+		std::array<double, s_batchSize> m_weights;
+	};
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef RANDOMGENERATOR_H
 #define RANDOMGENERATOR_H
 
+#include <cstdint>
 #include <random>
 #include <iostream>
 
@@ -37,10 +38,16 @@ namespace AnasenSim {
 		//For randomization of decimals in conversion from integer -> floating point for histograming
 		static double GetUniformFraction()
 		{
-			static std::uniform_real_distribution<double> distribution(0.0, 1.0);
+			static thread_local std::uniform_real_distribution<double> distribution(0.0, 1.0);
 			return distribution(GetGenerator());
 		}
 
+		//Each thread has its own engine. A worker's stream can be carried between threads (or saved) by copying the engine out
+		//with GetEngine and back in with SetEngine
+		static void SetSeed(uint64_t seed) { GetGenerator().seed(seed); }
+		static const std::mt19937_64& GetEngine() { return GetGenerator(); }
+		static void SetEngine(const std::mt19937_64& engine) { GetGenerator() = engine; }
+
 	private:
 		static std::mt19937_64& GetGenerator()
 		{
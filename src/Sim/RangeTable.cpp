@@ -0,0 +1,128 @@
+/*
+	RangeTable.cpp
+	Tabulated range-energy relation for one projectile in one material. The table is built once from catima
+	on a log-spaced grid of kinetic energy per nucleon, after which range and residual energy lookups are
+	log-log interpolations instead of full energy loss integrations.
+
+	Table data is immutable and shared between copies; it may be owned by the table or memory-mapped from a TableCache file.
+	Ranges are stored as areal density (g/cm^2) and converted to length with the material density at lookup, so one table
+	serves a material at any density (e.g. a gas pressure scan).
+*/
+#include "RangeTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace AnasenSim {
+
+	RangeTable::RangeTable() :
+		m_nucleonNumber(0.0), m_logLengthConversion(0.0)
+	{
+	}
+
+	RangeTable::RangeTable(const catima::Projectile& projectile, const catima::Material& material) :
+		m_nucleonNumber(projectile.A)
+	{
+		SetDensity(material.density());
+		catima::Projectile proj = projectile;
+		double previous = std::numeric_limits<double>::min();
+		std::shared_ptr<double[]> logRange(new double[s_nPoints]);
+		for(int i=0; i<s_nPoints; i++)
+		{
+			proj.T = std::exp(s_logMinEnergy + i * s_logEnergyStep);
+			double range = catima::range(proj, material); //g/cm^2
+			//Guard against catima returning zero at the bottom of its own grid; table must be monotonic
+			previous = std::max(range, previous);
+			logRange[i] = std::log(previous);
+		}
+		m_logRange = logRange;
+	}
+
+	RangeTable::RangeTable(const std::shared_ptr<const double[]>& logRange, double nucleonNumber) :
+		m_logRange(logRange), m_nucleonNumber(nucleonNumber), m_logLengthConversion(0.0)
+	{
+	}
+
+	RangeTable::~RangeTable() {}
+
+	void RangeTable::SetDensity(double density)
+	{
+		m_logLengthConversion = std::log(0.01 / density); //g/cm^2 -> m
+	}
+
+	//Log-log interpolation on the uniform log-energy grid. Out of range energies are extrapolated from the end segments
+	double RangeTable::GetRange(double energy) const
+	{
+		if(energy <= 0.0)
+			return 0.0;
+
+		double x = (std::log(energy / m_nucleonNumber) - s_logMinEnergy) / s_logEnergyStep;
+		int index = std::clamp(static_cast<int>(std::floor(x)), 0, s_nPoints - 2);
+		double frac = x - index;
+		return std::exp(m_logRange[index] + frac * (m_logRange[index + 1] - m_logRange[index]) + m_logLengthConversion);
+	}
+
+	//Inverse of GetRange; range grid is not uniform, so bin is found by binary search
+	double RangeTable::GetEnergy(double range) const
+	{
+		if(range <= 0.0)
+			return 0.0;
+
+		double logRange = std::log(range) - m_logLengthConversion;
+		const double* data = m_logRange.get();
+		const double* iter = std::upper_bound(data, data + s_nPoints, logRange);
+		int index = std::clamp(static_cast<int>(iter - data) - 1, 0, s_nPoints - 2);
+		double width = m_logRange[index + 1] - m_logRange[index];
+		double frac = width > 0.0 ? (logRange - m_logRange[index]) / width : 0.0;
+		return std::exp(s_logMinEnergy + (index + frac) * s_logEnergyStep) * m_nucleonNumber;
+	}
+
+	//Energy remaining after travelling pathLength. Returns 0 if the particle stops.
+	double RangeTable::GetEnergyAfterPath(double startEnergy, double pathLength) const
+	{
+		double residualRange = GetRange(startEnergy) - pathLength;
+		if(residualRange <= 0.0)
+			return 0.0;
+		return GetEnergy(residualRange);
+	}
+
+	//FNV-1a over everything that determines the table contents
+	uint64_t RangeTable::GetKey(const catima::Projectile& projectile, const catima::Material& material)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		auto combine = [&hash](const void* data, std::size_t size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			for(std::size_t i=0; i<size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ULL;
+			}
+		};
+
+		uint32_t version = s_version;
+		int nPoints = s_nPoints;
+		double gridMin = s_logMinEnergy, gridMax = s_logMaxEnergy;
+		combine(&version, sizeof(version));
+		combine(&nPoints, sizeof(nPoints));
+		combine(&gridMin, sizeof(gridMin));
+		combine(&gridMax, sizeof(gridMax));
+
+		double projA = projectile.A, projZ = projectile.Z;
+		combine(&projA, sizeof(projA));
+		combine(&projZ, sizeof(projZ));
+
+		for(int i=0; i<material.ncomponents(); i++)
+		{
+			auto element = material.get_element(i);
+			double elementA = element.A, elementZ = element.Z, elementStoich = element.stn;
+			combine(&elementA, sizeof(elementA));
+			combine(&elementZ, sizeof(elementZ));
+			combine(&elementStoich, sizeof(elementStoich));
+		}
+
+		return hash;
+	}
+
+}
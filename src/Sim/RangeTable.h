@@ -0,0 +1,56 @@
+/*
+	RangeTable.h
+	Tabulated range-energy relation for one projectile in one material. The table is built once from catima
+	on a log-spaced grid of kinetic energy per nucleon, after which range and residual energy lookups are
+	log-log interpolations instead of full energy loss integrations.
+
+	Table data is immutable and shared between copies; it may be owned by the table or memory-mapped from a TableCache file.
+	Ranges are stored as areal density (g/cm^2) and converted to length with the material density at lookup, so one table
+	serves a material at any density (e.g. a gas pressure scan).
+*/
+#ifndef RANGE_TABLE_H
+#define RANGE_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include "catima/gwm_integrators.h"
+
+namespace AnasenSim {
+
+	class RangeTable
+	{
+	public:
+		RangeTable();
+		RangeTable(const catima::Projectile& projectile, const catima::Material& material);
+		RangeTable(const std::shared_ptr<const double[]>& logRange, double nucleonNumber);
+		~RangeTable();
+
+		void SetDensity(double density); //g/cm^3
+
+		double GetRange(double energy) const; //energy: MeV, returns m
+		double GetEnergy(double range) const; //range: m, returns MeV
+		double GetEnergyAfterPath(double startEnergy, double pathLength) const; //startEnergy: MeV, pathLength: m, returns MeV
+
+		bool IsValid() const { return m_logRange != nullptr; }
+		const double* GetData() const { return m_logRange.get(); }
+		double GetNucleonNumber() const { return m_nucleonNumber; }
+
+		//Unique key for a projectile/material composition/grid combination, used to identify cached tables. Independent of density.
+		static uint64_t GetKey(const catima::Projectile& projectile, const catima::Material& material);
+		static constexpr int GetNumberOfPoints() { return s_nPoints; }
+
+	private:
+		std::shared_ptr<const double[]> m_logRange; //ln(range in g/cm^2) at each grid point
+		double m_nucleonNumber;
+		double m_logLengthConversion; //ln(m per g/cm^2) for the current density
+
+		static constexpr int s_nPoints = 1201; //200 points per decade
+		static constexpr double s_logMinEnergy = -6.907755278982137; //ln(1.0e-3 MeV/u)
+		static constexpr double s_logMaxEnergy = 6.907755278982137; //ln(1.0e3 MeV/u)
+		static constexpr double s_logEnergyStep = (s_logMaxEnergy - s_logMinEnergy) / (s_nPoints - 1);
+		static constexpr uint32_t s_version = 2; //Bump whenever the table contents change meaning
+	};
+
+}
+
+#endif
@@ -20,7 +20,7 @@ namespace AnasenSim {
 	{
 	}
 	
-	Reaction::Reaction(Nucleus* target, Nucleus* projectile, Nucleus* ejectile, Nucleus* residual) :
+	Reaction::Reaction(NucleusRecord* target, NucleusRecord* projectile, NucleusRecord* ejectile, NucleusRecord* residual) :
 		m_target(nullptr), m_projectile(nullptr), m_ejectile(nullptr), m_residual(nullptr),
 		m_bke(0), m_theta(0), m_phi(0), m_ex(0), m_rxnLayer(0)
 	{
@@ -45,7 +45,7 @@ namespace AnasenSim {
 		}
 	}
 	
-	void Reaction::BindNuclei(Nucleus* target, Nucleus* projectile, Nucleus* ejectile, Nucleus* residual)
+	void Reaction::BindNuclei(NucleusRecord* target, NucleusRecord* projectile, NucleusRecord* ejectile, NucleusRecord* residual)
 	{
 		m_target = target;
 		m_projectile = projectile;
@@ -86,6 +86,19 @@ namespace AnasenSim {
 			return true;
 	}
 
+	//CheckReactionThreshold solved for the excitation: beamEnergy >= -Q*S/(S - mp), with S the sum of the product masses
+	double Reaction::GetMaxReactionExcitation(double beamEnergy) const
+	{
+		double productMass = m_ejectile->groundStateMass + m_residual->groundStateMass;
+		return m_target->groundStateMass + m_projectile->groundStateMass - productMass +
+			   beamEnergy * (productMass - m_projectile->groundStateMass) / productMass;
+	}
+
+	double Reaction::GetMaxDecayExcitation(double targetExcitation) const
+	{
+		return m_target->groundStateMass + targetExcitation - (m_ejectile->groundStateMass + m_residual->groundStateMass);
+	}
+
 	//For use with nabin testing. Q-value is hardcoded.
 	double Reaction::SampleExcitationPhaseSpace(double beamEnergy, double beamTheta, double beamPhi, double ejectThetaCM, double ejectPhiCM)
 	{
@@ -119,7 +132,7 @@ namespace AnasenSim {
 	//For use with lab frame restricted angles. May not give appropriate disribution for ejectile
 	void Reaction::CalculateReactionThetaLab()
 	{
-		m_target->vec4.SetPxPyPzE(0.,0.,0.,m_target->groundStateMass);
+		m_target->SetVec4(ROOT::Math::PxPyPzEVector(0.,0.,0.,m_target->groundStateMass));
 		double beamP = std::sqrt(m_bke*(m_bke + 2.0 * m_projectile->groundStateMass));
 		double beamE = m_bke + m_projectile->groundStateMass;
 		m_projectile->SetVec4Spherical(m_beamTheta, m_beamPhi, beamP, beamE);
@@ -148,7 +161,7 @@ namespace AnasenSim {
 	
 		m_ejectile->SetVec4Spherical(m_theta, m_phi, ejectP, ejectE);
 	
-		m_residual->vec4 = m_target->vec4 + m_projectile->vec4 - m_ejectile->vec4;
+		m_residual->SetVec4(m_target->GetVec4() + m_projectile->GetVec4() - m_ejectile->GetVec4());
 	
 		ejectP = std::sqrt(ejectKE*(ejectKE + 2.0 * m_ejectile->groundStateMass));
 		ejectE = ejectKE + m_ejectile->groundStateMass;
@@ -160,7 +173,7 @@ namespace AnasenSim {
 	void Reaction::CalculateReactionThetaCM()
 	{
 		//Target assumed at rest, with 0 excitation energy
-		m_target->vec4.SetPxPyPzE(0.,0.,0.,m_target->groundStateMass);
+		m_target->SetVec4(ROOT::Math::PxPyPzEVector(0.,0.,0.,m_target->groundStateMass));
 		double beamP = std::sqrt(m_bke*(m_bke + 2.0 * m_projectile->groundStateMass));
 		double beamE = m_bke + m_projectile->groundStateMass;
 		m_projectile->SetVec4Spherical(m_beamTheta, m_beamPhi, beamP, beamE);
@@ -172,7 +185,7 @@ namespace AnasenSim {
 		ASIM_ASSERT(m_bke > Ethresh, "Reaction energy not above threshold");
 		
 		
-		ROOT::Math::PxPyPzEVector parent = m_target->vec4 + m_projectile->vec4;
+		ROOT::Math::PxPyPzEVector parent = m_target->GetVec4() + m_projectile->GetVec4();
 		ROOT::Math::Boost boost(parent.BoostToCM());
 		parent = boost*parent;
 		double ejectE_cm = (std::pow(m_ejectile->groundStateMass, 2.0) - 
@@ -180,16 +193,16 @@ namespace AnasenSim {
 							(2.0*parent.E());
 		double ejectP_cm = std::sqrt(ejectE_cm*ejectE_cm - std::pow(m_ejectile->groundStateMass, 2.0));
 		m_ejectile->SetVec4Spherical(m_theta, m_phi, ejectP_cm, ejectE_cm);
-		m_ejectile->vec4 = boost.Inverse() * m_ejectile->vec4;
-		m_residual->vec4 = m_target->vec4 + m_projectile->vec4 - m_ejectile->vec4;
+		m_ejectile->SetVec4(boost.Inverse() * m_ejectile->GetVec4());
+		m_residual->SetVec4(m_target->GetVec4() + m_projectile->GetVec4() - m_ejectile->GetVec4());
 	
 		double ejectKE = m_ejectile->GetKE();
-		double ejectP = m_ejectile->vec4.P();
-		double ejectE = m_ejectile->vec4.E();
+		double ejectP = m_ejectile->GetVec4().P();
+		double ejectE = m_ejectile->GetVec4().E();
 		//energy loss for ejectile (after reaction!)
 		ejectP = std::sqrt(ejectKE*(ejectKE + 2.0 * m_ejectile->groundStateMass));
 		ejectE = ejectKE + m_ejectile->groundStateMass;
-		m_ejectile->SetVec4Spherical(m_ejectile->vec4.Theta(), m_ejectile->vec4.Phi(), ejectP, ejectE);
+		m_ejectile->SetVec4Spherical(m_ejectile->GetVec4().Theta(), m_ejectile->GetVec4().Phi(), ejectP, ejectE);
 
 	}
 	
@@ -202,26 +215,28 @@ namespace AnasenSim {
 	void Reaction::CalculateDecay()
 	{
 		double residualMass = m_residual->groundStateMass + m_ex;
-		double Q = m_target->vec4.M() - m_ejectile->groundStateMass - residualMass;
+		ROOT::Math::PxPyPzEVector parent = m_target->GetVec4();
+		double Q = parent.M() - m_ejectile->groundStateMass - residualMass;
 		ASIM_ASSERT(Q > 0, "Decay not above threshold");
 	
-		ROOT::Math::Boost boost(m_target->vec4.BoostToCM());
-		m_target->vec4 = boost*m_target->vec4;
+		ROOT::Math::Boost boost(parent.BoostToCM());
+		parent = boost*parent;
 		double ejectE_cm = (m_ejectile->groundStateMass*m_ejectile->groundStateMass - 
-						   residualMass*residualMass + m_target->vec4.E()*m_target->vec4.E()) /
-					       (2.0*m_target->vec4.E());
+						   residualMass*residualMass + parent.E()*parent.E()) /
+					       (2.0*parent.E());
 		double ejectP_cm = std::sqrt(ejectE_cm*ejectE_cm - m_ejectile->groundStateMass*m_ejectile->groundStateMass);
 	
 		m_ejectile->SetVec4Spherical(m_theta, m_phi, ejectP_cm, ejectE_cm);
 		m_ejectile->thetaCM = m_theta;
 	
-		m_target->vec4 = boost.Inverse() * m_target->vec4;
-		m_ejectile->vec4 = boost.Inverse() * m_ejectile->vec4;
+		parent = boost.Inverse() * parent;
+		m_target->SetVec4(parent);
+		m_ejectile->SetVec4(boost.Inverse() * m_ejectile->GetVec4());
 	
-		m_residual->vec4 = m_target->vec4 - m_ejectile->vec4;
+		m_residual->SetVec4(parent - m_ejectile->GetVec4());
 
 		if (std::isnan(m_ejectile->GetKE()))
-			std::cout << m_ejectile->isotopicSymbol << " nanned! " << " Q: " << Q << " Resid mass: " << residualMass << " Target mass: " << m_target->vec4.M() << " eject mass: " << m_ejectile->groundStateMass << std::endl;
+			std::cout << GetIsotopicSymbol(*m_ejectile) << " nanned! " << " Q: " << Q << " Resid mass: " << residualMass << " Target mass: " << parent.M() << " eject mass: " << m_ejectile->groundStateMass << std::endl;
 	}
 
 }
@@ -9,7 +9,7 @@
 #ifndef REACTION_H
 #define REACTION_H
 
-#include "Dict/Nucleus.h"
+#include "NucleusRecord.h"
 
 namespace AnasenSim {
 
@@ -17,12 +17,12 @@ namespace AnasenSim {
 	{
 	public:
 		Reaction();
-		Reaction(Nucleus* target, Nucleus* projectile, Nucleus* ejectile, Nucleus* residual);
+		Reaction(NucleusRecord* target, NucleusRecord* projectile, NucleusRecord* ejectile, NucleusRecord* residual);
 		~Reaction();
 		bool Calculate(); //do sim
 
 		//Bind system nuclei to the specific reaction. Reaction does NOT own nuclei
-		void BindNuclei(Nucleus* target, Nucleus* projectile, Nucleus* ejectile, Nucleus* residual);
+		void BindNuclei(NucleusRecord* target, NucleusRecord* projectile, NucleusRecord* ejectile, NucleusRecord* residual);
 		void SetBeamKE(double bke) { m_bke = bke; }
 		void SetBeamTheta(double theta) { m_beamTheta = theta; }
 		void SetBeamPhi(double phi) { m_beamPhi = phi; }
@@ -32,15 +32,18 @@ namespace AnasenSim {
 		void SetExcitation(double ex) { m_ex = ex; }
 
 		//Can rebind individuals if needed
-		void BindTarget(Nucleus* nuc) { m_target = nuc; }
-		void BindProjectile(Nucleus* nuc) { m_projectile = nuc; }
-		void BindEjectile(Nucleus* nuc) { m_ejectile = nuc; }
-		void BindResidual(Nucleus* nuc) { m_residual = nuc; }
+		void BindTarget(NucleusRecord* nuc) { m_target = nuc; }
+		void BindProjectile(NucleusRecord* nuc) { m_projectile = nuc; }
+		void BindEjectile(NucleusRecord* nuc) { m_ejectile = nuc; }
+		void BindResidual(NucleusRecord* nuc) { m_residual = nuc; }
 
 		bool IsDecay() const { return m_isDecay; }
 		//Use these when sampling to see if a valid excitation/beam energy configuration was sampled.
 		bool CheckReactionThreshold(double beamEnergy, double excitation);
 		bool CheckDecayThreshold(double targetExcitation, double residualExcitation);
+		//Largest residual excitation (MeV) the threshold checks above accept
+		double GetMaxReactionExcitation(double beamEnergy) const;
+		double GetMaxDecayExcitation(double targetExcitation) const;
 		//Testing against nabin method
 		double SampleExcitationPhaseSpace(double beamEnergy, double beamTheta, double beamPhi, double ejectThetaCM, double ejectPhiCM);
 
@@ -51,10 +54,10 @@ namespace AnasenSim {
 		void CalculateReactionThetaCM();
 	
 		//Reactants -> NOT OWNED BY RXN
-		Nucleus* m_target;
-		Nucleus* m_projectile;
-		Nucleus* m_ejectile;
-		Nucleus* m_residual;
+		NucleusRecord* m_target;
+		NucleusRecord* m_projectile;
+		NucleusRecord* m_ejectile;
+		NucleusRecord* m_residual;
 
 		double m_bke, m_theta, m_phi, m_ex;
 		double m_beamTheta, m_beamPhi;
@@ -0,0 +1,26 @@
+#include "ReactionChain.h"
+
+namespace AnasenSim {
+
+	//A reaction followed by the decay of its residual
+	static bool IsTwoStep(const StepParameters& first, const StepParameters& second)
+	{
+		if(first.rxnType != RxnType::Reaction || second.rxnType != RxnType::Decay || first.Z.size() != 3 || first.A.size() != 3 ||
+		   second.Z.empty() || second.A.empty())
+			return false;
+		return second.Z[0] == first.Z[0] + first.Z[1] - first.Z[2] && second.A[0] == first.A[0] + first.A[1] - first.A[2];
+	}
+
+	ReactionChain* CreateSystem(const SystemParameters& params)
+	{
+		const std::vector<StepParameters>& steps = params.stepParams;
+		if(steps.size() == 1 && steps[0].rxnType == RxnType::Decay)
+			return new ReactionChain(std::in_place_type<DecaySystem>, params);
+		else if(steps.size() == 1 && steps[0].rxnType == RxnType::Reaction)
+			return new ReactionChain(std::in_place_type<OneStepSystem>, params);
+		else if(steps.size() == 2 && IsTwoStep(steps[0], steps[1]))
+			return new ReactionChain(std::in_place_type<TwoStepSystem>, params);
+		return new ReactionChain(std::in_place_type<ChainSystem>, params);
+	}
+
+}
@@ -0,0 +1,56 @@
+/*
+	ReactionChain.h
+	The reaction system of a configuration, held by value as one of the concrete system types. Every per-event call is
+	dispatched with std::visit over the closed set of systems, so there are no virtual calls in the generation loop and each
+	hand-written system's step sequence and nucleus count are fixed at compile time. Chains they do not cover run on the
+	generic ChainSystem. Adding a system means adding it to SystemVariant and to CreateSystem.
+*/
+#ifndef REACTION_CHAIN_H
+#define REACTION_CHAIN_H
+
+#include "DecaySystem.h"
+#include "OneStepSystem.h"
+#include "TwoStepSystem.h"
+#include "ChainSystem.h"
+
+#include <variant>
+
+namespace AnasenSim {
+
+	class ReactionChain
+	{
+	public:
+		using SystemVariant = std::variant<DecaySystem, OneStepSystem, TwoStepSystem, ChainSystem>;
+
+		//Systems cannot move once built, so the chosen system is constructed in place
+		template<typename System>
+		ReactionChain(std::in_place_type_t<System> type, const SystemParameters& params) :
+			m_system(type, params)
+		{
+		}
+
+		void RunSystem() { std::visit([](auto& system) { system.RunSystem(); }, m_system); }
+
+		//Copy the nuclei of the current event into an event buffer; does not allocate once the buffer has grown to size
+		void GetNuclei(std::vector<NucleusRecord>& nuclei) const
+		{
+			std::visit([&nuclei](const auto& system) { nuclei.assign(system.GetNuclei().begin(), system.GetNuclei().end()); }, m_system);
+		}
+
+		const std::string& GetSystemEquation() const { return GetBase().GetSystemEquation(); }
+		bool IsValid() const { return GetBase().IsValid(); }
+
+	private:
+		const ReactionSystem& GetBase() const
+		{
+			return std::visit([](const ReactionSystem& system) -> const ReactionSystem& { return system; }, m_system);
+		}
+
+		SystemVariant m_system;
+	};
+
+	//The hand-written system matching the steps if there is one, otherwise a ChainSystem
+	ReactionChain* CreateSystem(const SystemParameters& params);
+}
+
+#endif
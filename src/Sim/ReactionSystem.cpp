@@ -1,26 +1,10 @@
 #include "ReactionSystem.h"
-#include "DecaySystem.h"
-#include "OneStepSystem.h"
-#include "TwoStepSystem.h"
 
-namespace AnasenSim {
-
-	ReactionSystem* CreateSystem(const SystemParameters& params)
-	{
-		switch(params.stepParams.size())
-		{
-			case 1:
-			{
-				if(params.stepParams[0].rxnType == RxnType::Decay)
-					return new DecaySystem(params);
-				else if (params.stepParams[0].rxnType == RxnType::Reaction)
-					return new OneStepSystem(params);
-			}
-			case 2: return new TwoStepSystem(params);
-		}
+#include <cmath>
+#include <iostream>
+#include <limits>
 
-		return nullptr;
-	}
+namespace AnasenSim {
 
 	ReactionSystem::ReactionSystem(const SystemParameters& params) :
 		m_params(params), m_isValid(true), m_sysEquation("")
@@ -31,16 +15,53 @@ namespace AnasenSim {
 	{
 	}
 
-	void ReactionSystem::ResetNucleiDetected()
+	/*
+		The beam range table gives the path length to the reaction point; straggling, which grows roughly as the square root of
+		the path, is interpolated in its square over a uniform grid from the target entrance to the end of the beam range.
+	*/
+	void ReactionSystem::InitBeamTables(const NucleusRecord& projectile)
+	{
+		m_params.target.InitRangeTable(projectile.Z, projectile.A);
+		double maxPath = m_params.target.GetPathLength(projectile.Z, projectile.A, m_params.initialBeamEnergy, 0.0);
+		m_beamPathStep = maxPath / (s_nBeamStragglingPoints - 1);
+		m_beamStragglingSq.resize(s_nBeamStragglingPoints);
+		m_beamStragglingSq[0] = 0.0;
+		for(std::size_t i=1; i<s_nBeamStragglingPoints; i++)
+		{
+			double straggling = m_params.target.GetAngularStraggling(projectile.Z, projectile.A, m_params.initialBeamEnergy, i * m_beamPathStep);
+			m_beamStragglingSq[i] = straggling * straggling;
+		}
+	}
+
+	bool ReactionSystem::InitLineshape(Lineshape& lineshape, const StepParameters& step, double minEx, double maxEx)
 	{
-		for(Nucleus& nucleus : m_nuclei)
+		lineshape = GetFullLineshape(step);
+		if(!lineshape.Truncate(minEx, maxEx))
 		{
-			nucleus.isDetected = false;
-			nucleus.siliconDetKE = 0.0; //MeV
-			nucleus.siVector.SetXYZ(0., 0., 0.);
-        	nucleus.pcDetE = 0.0; //MeV
-			nucleus.pcVector.SetXYZ(0., 0., 0.);
-			nucleus.siDetectorName = "";
+			m_isValid = false;
+			std::cerr << "Residual excitation lineshape has no weight between the kinematic limits " << minEx << " and " << maxEx
+					  << " MeV at ReactionSystem::InitLineshape!" << std::endl;
+			return false;
 		}
+		return true;
+	}
+
+	Lineshape ReactionSystem::GetFullLineshape(const StepParameters& step)
+	{
+		Lineshape lineshape = step.lineshape;
+		lineshape.SetParameters(step.meanResidualEx, step.sigmaResidualEx);
+		return lineshape;
+	}
+
+	double ReactionSystem::GetBeamStraggling(double pathLength) const
+	{
+		if(m_beamStragglingSq.empty() || !(pathLength > 0.0) || m_beamPathStep <= 0.0)
+			return 0.0;
+		double index = pathLength / m_beamPathStep;
+		std::size_t low = std::size_t(index);
+		if(low >= s_nBeamStragglingPoints - 1)
+			return std::sqrt(m_beamStragglingSq.back());
+		double fraction = index - low;
+		return std::sqrt(m_beamStragglingSq[low] + fraction * (m_beamStragglingSq[low + 1] - m_beamStragglingSq[low]));
 	}
 }
\ No newline at end of file
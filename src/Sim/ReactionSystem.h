@@ -5,6 +5,9 @@
 #include "RxnType.h"
 #include "Reaction.h"
 #include "Target.h"
+#include "AngularDistribution.h"
+#include "Lineshape.h"
+#include <array>
 #include <vector>
 #include <random>
 
@@ -17,6 +20,8 @@ namespace AnasenSim {
 		std::vector<int> A;
 		double meanResidualEx = -1.0;
 		double sigmaResidualEx = -1.0;
+		AngularDistribution angularDistribution; //CM polar angle of a two-body step; isotropic unless read from a table
+		Lineshape lineshape; //Residual excitation; Normal(meanResidualEx, sigmaResidualEx) unless another shape is set
 	};
 
 	struct SystemParameters
@@ -28,38 +33,46 @@ namespace AnasenSim {
 		bool sampleBeam = false;
 	};
 
+	/*
+		State and helpers shared by the concrete systems. There is no virtual interface: each system is a complete type with its
+		nuclei in a fixed-size array and a non-virtual RunSystem, and ReactionChain dispatches to them statically. Systems bind
+		their Reactions to their own nuclei, so they can be neither copied nor moved.
+	*/
 	class ReactionSystem
 	{
 	public:
-		ReactionSystem(const SystemParameters& params);
-		virtual ~ReactionSystem();
-
-		virtual void RunSystem() = 0;
+		ReactionSystem(const ReactionSystem&) = delete;
+		ReactionSystem& operator=(const ReactionSystem&) = delete;
 
-		std::vector<Nucleus>* GetNuclei() { return &m_nuclei; }
 		const std::string& GetSystemEquation() const { return m_sysEquation; }
 		bool IsValid() const { return m_isValid; }
-		//Need to reset the detected status of the nulcei after they're written to disk
-		void ResetNucleiDetected();
 
 	protected:
-		virtual void SetSystemEquation() = 0;
+		ReactionSystem(const SystemParameters& params);
+		~ReactionSystem();
+
+		//Tabulate beam transport in the target for a sampled beam energy, so per-event sampling does not call catima
+		void InitBeamTables(const NucleusRecord& projectile);
+		double GetBeamStraggling(double pathLength) const; //pathLength: m, returns rad
+		//Copy the step's lineshape into lineshape, limited to the kinematically allowed [minEx, maxEx]. On failure the system is invalid
+		bool InitLineshape(Lineshape& lineshape, const StepParameters& step, double minEx, double maxEx);
+		//Lineshape of a step before any kinematic limit, for the limits of the steps around it
+		static Lineshape GetFullLineshape(const StepParameters& step);
 
 		SystemParameters m_params;
 
 		bool m_isValid;
 
 		std::string m_sysEquation;
-		std::vector<Nucleus> m_nuclei;
+
+		std::vector<double> m_beamStragglingSq; //Squared angular straggling on a uniform grid of beam path length
+		double m_beamPathStep = 0.0; //m
 
 		static constexpr double s_deg2rad = M_PI/180.0;
-		static constexpr double s_cosThetaMin = -1.0;
-		static constexpr double s_cosThetaMax = 1.0;
 		static constexpr double s_phiMin = 0.0;
 		static constexpr double s_phiMax = 2.0*M_PI;
+		static constexpr std::size_t s_nBeamStragglingPoints = 513;
 	};
-
-	ReactionSystem* CreateSystem(const SystemParameters& params);
 }
 
 #endif
\ No newline at end of file
@@ -9,6 +9,7 @@ namespace AnasenSim {
 	{
 		Decay,
 		Reaction,
+		PhaseSpace,
 		None
 	};
 
@@ -25,6 +26,8 @@ namespace AnasenSim {
 			return RxnType::Decay;
 		else if (type == "Reaction")
 			return RxnType::Reaction;
+		else if (type == "PhaseSpace")
+			return RxnType::PhaseSpace;
 		else
 			return RxnType::None;
 	}
@@ -3,26 +3,90 @@
 
 #include <cassert>
 #include <string>
+#include <string_view>
 
 #define ASIM_ASSERT(expr, message) assert(expr && message)
 
 #include "MassLookup.h"
 #include "Dict/Nucleus.h"
+#include "NucleusRecord.h"
 
 namespace AnasenSim {
 
-    static Nucleus CreateNucleus(uint32_t z, uint32_t a, Nucleus::ReactionRole role)
+    static NucleusRecord CreateNucleus(uint32_t z, uint32_t a, Nucleus::ReactionRole role, uint32_t step = 0)
     {
-        Nucleus nuc;
+        NucleusRecord nuc;
         nuc.Z = z;
         nuc.A = a;
         nuc.groundStateMass = MassLookup::GetInstance().FindMass(z, a);
-        nuc.isotopicSymbol = MassLookup::GetInstance().FindSymbol(z, a);
-        nuc.vec4 = ROOT::Math::PxPyPzEVector(0., 0., 0., nuc.groundStateMass);
+        nuc.SetVec4(ROOT::Math::PxPyPzEVector(0., 0., 0., nuc.groundStateMass));
         nuc.role = role;
+        nuc.step = step;
         return nuc;
     }
 
+    static std::string_view GetIsotopicSymbol(const NucleusRecord& nucleus)
+    {
+        return MassLookup::GetInstance().FindSymbol(nucleus.Z, nucleus.A);
+    }
+
+    //Clear the detector response of a nucleus, leaving the generator-level (truth) values untouched
+    static void ResetNucleusDetection(NucleusRecord& nucleus)
+    {
+        nucleus.isDetected = false;
+        nucleus.siliconDetKE = 0.0; //MeV
+        nucleus.SetSiVector(ROOT::Math::XYZPoint(0., 0., 0.));
+        nucleus.pcDetE = 0.0; //MeV
+        nucleus.SetPCVector(ROOT::Math::XYZPoint(0., 0., 0.));
+        nucleus.siDetector = SiliconDetector::None;
+    }
+
+    //Persisted form of a record. The symbol is only looked up when the species changes, so refilling the same output
+    //buffer event after event does not allocate
+    static void ToNucleus(const NucleusRecord& record, Nucleus& nucleus)
+    {
+        if(nucleus.isotopicSymbol.empty() || nucleus.Z != record.Z || nucleus.A != record.A)
+            nucleus.isotopicSymbol = GetIsotopicSymbol(record);
+        nucleus.Z = record.Z;
+        nucleus.A = record.A;
+        nucleus.groundStateMass = record.groundStateMass;
+        nucleus.thetaCM = record.thetaCM;
+        nucleus.vec4 = record.GetVec4();
+        nucleus.rxnPoint = record.GetRxnPoint();
+        nucleus.role = record.role;
+        nucleus.step = record.step;
+        nucleus.isDetected = record.isDetected;
+        nucleus.siliconDetKE = record.siliconDetKE;
+        nucleus.siVector = record.GetSiVector();
+        nucleus.pcDetE = record.pcDetE;
+        nucleus.pcVector = record.GetPCVector();
+        nucleus.siDetectorName = SiliconDetectorToString(record.siDetector);
+    }
+
+    static NucleusRecord ToNucleusRecord(const Nucleus& nucleus)
+    {
+        NucleusRecord record;
+        record.Z = nucleus.Z;
+        record.A = nucleus.A;
+        record.groundStateMass = nucleus.groundStateMass;
+        record.thetaCM = nucleus.thetaCM;
+        record.SetVec4(nucleus.vec4);
+        record.SetRxnPoint(nucleus.rxnPoint);
+        record.role = nucleus.role;
+        record.step = nucleus.step;
+        record.isDetected = nucleus.isDetected;
+        record.siliconDetKE = nucleus.siliconDetKE;
+        record.SetSiVector(nucleus.siVector);
+        record.pcDetE = nucleus.pcDetE;
+        record.SetPCVector(nucleus.pcVector);
+        for(SiliconDetector detector : {SiliconDetector::Barrel1, SiliconDetector::Barrel2, SiliconDetector::FQQQ})
+        {
+            if(nucleus.siDetectorName == SiliconDetectorToString(detector))
+                record.siDetector = detector;
+        }
+        return record;
+    }
+
     static std::string ReactionRoleToString(Nucleus::ReactionRole role)
     {
         switch(role)
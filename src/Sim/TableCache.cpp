@@ -0,0 +1,118 @@
+/*
+	TableCache.cpp
+	On-disk cache of RangeTables. Each table is stored in its own file named by the RangeTable key (a hash of the material,
+	projectile, and grid settings). Cached files are memory-mapped read-only on load, so warm starts skip table construction
+	and share the pages between jobs running on the same node.
+*/
+#include "TableCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace AnasenSim {
+
+	TableCache::TableCache(const std::filesystem::path& directory) :
+		m_directory(directory), m_isValid(false)
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(m_directory, ec);
+		if(ec || !std::filesystem::is_directory(m_directory, ec))
+		{
+			std::cerr << "Unable to use table cache directory " << m_directory << " because: " << ec.message() << std::endl;
+			return;
+		}
+		m_isValid = true;
+	}
+
+	TableCache::~TableCache() {}
+
+	std::filesystem::path TableCache::GetFilePath(uint64_t key) const
+	{
+		std::stringstream stream;
+		stream << std::hex << std::setw(16) << std::setfill('0') << key << ".rtab";
+		return m_directory / stream.str();
+	}
+
+	bool TableCache::Load(uint64_t key, RangeTable& table) const
+	{
+		if(!m_isValid)
+			return false;
+
+		std::filesystem::path filepath = GetFilePath(key);
+		int fd = open(filepath.c_str(), O_RDONLY);
+		if(fd == -1)
+			return false;
+
+		struct stat fileStats;
+		std::size_t expectedSize = sizeof(Header) + sizeof(double) * RangeTable::GetNumberOfPoints();
+		if(fstat(fd, &fileStats) == -1 || static_cast<std::size_t>(fileStats.st_size) != expectedSize)
+		{
+			close(fd);
+			return false;
+		}
+
+		void* mapped = mmap(nullptr, expectedSize, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd); //mapping stays valid after the descriptor is closed
+		if(mapped == MAP_FAILED)
+			return false;
+
+		const Header* header = static_cast<const Header*>(mapped);
+		if(std::memcmp(header->magic, s_magic, sizeof(s_magic)) != 0 || header->version != s_version || header->key != key ||
+		   header->nPoints != static_cast<uint32_t>(RangeTable::GetNumberOfPoints()))
+		{
+			munmap(mapped, expectedSize);
+			return false;
+		}
+
+		//Mapping is released when the last table sharing it is destroyed
+		std::shared_ptr<void> mapping(mapped, [expectedSize](void* region) { munmap(region, expectedSize); });
+		const double* data = reinterpret_cast<const double*>(static_cast<const char*>(mapped) + sizeof(Header));
+		table = RangeTable(std::shared_ptr<const double[]>(mapping, data), header->nucleonNumber);
+		return true;
+	}
+
+	//Written to a temporary file then renamed, so concurrent jobs never map a partially written table
+	void TableCache::Store(uint64_t key, const RangeTable& table) const
+	{
+		if(!m_isValid || !table.IsValid())
+			return;
+
+		std::filesystem::path filepath = GetFilePath(key);
+		std::filesystem::path tempPath = filepath;
+		tempPath += "." + std::to_string(getpid()) + ".tmp";
+
+		Header header;
+		std::memcpy(header.magic, s_magic, sizeof(s_magic));
+		header.version = s_version;
+		header.nPoints = RangeTable::GetNumberOfPoints();
+		header.key = key;
+		header.nucleonNumber = table.GetNucleonNumber();
+
+		{
+			std::ofstream output(tempPath, std::ios::binary);
+			if(!output.is_open())
+			{
+				std::cerr << "Unable to write table cache file " << tempPath << std::endl;
+				return;
+			}
+			output.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			output.write(reinterpret_cast<const char*>(table.GetData()), sizeof(double) * RangeTable::GetNumberOfPoints());
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, filepath, ec);
+		if(ec)
+		{
+			std::cerr << "Unable to write table cache file " << filepath << " because: " << ec.message() << std::endl;
+			std::filesystem::remove(tempPath, ec);
+		}
+	}
+
+}
@@ -0,0 +1,49 @@
+/*
+	TableCache.h
+	On-disk cache of RangeTables. Each table is stored in its own file named by the RangeTable key (a hash of the material,
+	projectile, and grid settings). Cached files are memory-mapped read-only on load, so warm starts skip table construction
+	and share the pages between jobs running on the same node.
+*/
+#ifndef TABLE_CACHE_H
+#define TABLE_CACHE_H
+
+#include "RangeTable.h"
+
+#include <filesystem>
+
+namespace AnasenSim {
+
+	class TableCache
+	{
+	public:
+		TableCache(const std::filesystem::path& directory);
+		~TableCache();
+
+		//Returns true and fills table if a valid cache file exists for key
+		bool Load(uint64_t key, RangeTable& table) const;
+		void Store(uint64_t key, const RangeTable& table) const;
+
+		bool IsValid() const { return m_isValid; }
+
+	private:
+		std::filesystem::path GetFilePath(uint64_t key) const;
+
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t nPoints;
+			uint64_t key;
+			double nucleonNumber;
+		};
+
+		std::filesystem::path m_directory;
+		bool m_isValid;
+
+		static constexpr char s_magic[8] = {'A', 'S', 'I', 'M', 'R', 'T', 'A', 'B'};
+		static constexpr uint32_t s_version = 1;
+	};
+
+}
+
+#endif
@@ -14,8 +14,10 @@ Written by G.W. McCann Aug. 2020
 #include "SimBase.h"
 #include "catima/nucdata.h"
 #include "Detectors/IsEqual.h"
+#include "Utils/UUID.h"
 
 #include <iostream>
+#include <mutex>
 
 namespace AnasenSim {
 
@@ -36,14 +38,16 @@ namespace AnasenSim {
 	/*Calculates energy loss for travelling all the way through the target*/
 	//ZP, AP: projectile isotope, startEnergy: MeV, pathLength: m
 	//return eloss in MeV
-	double Target::GetEnergyLoss(int zp, int ap, double startEnergy, double pathLength)
+	double Target::GetEnergyLoss(int zp, int ap, double startEnergy, double pathLength) const
 	{
 		if(Precision::IsFloatLessOrAlmostEqual(startEnergy, 0.0, s_epsilon))
 			return 0.0;
 		catima::Projectile proj(MassLookup::GetInstance().FindMassU(zp, ap), zp, 0.0, 0.0);
 		proj.T = startEnergy/proj.A;
-		m_material.thickness_cm(pathLength * 100.0); //Takes in a path length and calculates density corrected thickness to thickness param
-		return  startEnergy - (catima::energy_out(proj, m_material) * proj.A);
+		catima::Material material = m_material;
+		material.thickness_cm(pathLength * 100.0); //Takes in a path length and calculates density corrected thickness to thickness param
+		std::scoped_lock<std::mutex> guard(GetCatimaMutex());
+		return  startEnergy - (catima::energy_out(proj, material) * proj.A);
 	}
 
 	/*Calculates reverse energy loss for travelling all the way through the target*/
@@ -56,14 +60,20 @@ namespace AnasenSim {
 		catima::Projectile proj(MassLookup::GetInstance().FindMassU(zp, ap), zp, 0.0, 0.0);
 		proj.T = finalEnergy/proj.A;
 		m_material.thickness_cm(pathLength * 100.0);
+		std::scoped_lock<std::mutex> guard(GetCatimaMutex());
 		return catima::reverse_integrate_energyloss(proj, m_material);
 	}
 
 	//Get the path length (range) for a particle with incoming energy startEnergy and a outgoing energy finalEnergy 
-	double Target::GetPathLength(int zp, int ap, double startEnergy, double finalEnergy)
+	double Target::GetPathLength(int zp, int ap, double startEnergy, double finalEnergy) const
 	{
+		const RangeTable* table = GetRangeTable(zp, ap);
+		if(table != nullptr)
+			return table->GetRange(startEnergy) - table->GetRange(finalEnergy);
+
 		double densityInv = 1.0/m_material.density();
 		catima::Projectile proj(MassLookup::GetInstance().FindMassU(zp, ap), zp, 0.0, 0.0);
+		std::scoped_lock<std::mutex> guard(GetCatimaMutex());
 		proj.T = startEnergy/proj.A;
 		double stopRange = catima::range(proj, m_material); //get the total range for startEnergy -> 0, returns g/cm^2!
 		proj.T = finalEnergy/proj.A;
@@ -78,7 +88,117 @@ namespace AnasenSim {
 		proj.T = energy/proj.A;
 		m_material.thickness_cm(pathLength * 100.0);
 		proj.T = energy/proj.A;
+		std::scoped_lock<std::mutex> guard(GetCatimaMutex());
 		return catima::angular_straggling(proj, m_material);
 	}
 
+	/*
+		Tables are density independent, so every Target with the same composition shares one table per projectile through
+		a process-wide registry. Lookup order is registry, then disk cache, then a fresh build.
+	*/
+	void Target::InitRangeTable(int zp, int ap, const TableCache* cache)
+	{
+		static std::unordered_map<uint64_t, RangeTable> s_registry;
+		static std::mutex s_registryMutex;
+
+		uint32_t key = GetUUID(zp, ap);
+		if(m_rangeTables.find(key) != m_rangeTables.end())
+			return;
+		catima::Projectile proj(MassLookup::GetInstance().FindMassU(zp, ap), zp, 0.0, 0.0);
+		uint64_t tableKey = RangeTable::GetKey(proj, m_material);
+
+		RangeTable table;
+		{
+			std::scoped_lock<std::mutex> guard(s_registryMutex);
+			auto iter = s_registry.find(tableKey);
+			if(iter != s_registry.end())
+				table = iter->second;
+			else
+			{
+				if(cache == nullptr || !cache->Load(tableKey, table))
+				{
+					std::scoped_lock<std::mutex> catimaGuard(GetCatimaMutex());
+					table = RangeTable(proj, m_material);
+					if(cache != nullptr)
+						cache->Store(tableKey, table);
+				}
+				s_registry[tableKey] = table;
+			}
+		}
+		table.SetDensity(m_material.density());
+		m_rangeTables[key] = table;
+	}
+
+	void Target::SetDensity(double density)
+	{
+		m_material.density(density);
+		for(auto& [key, table] : m_rangeTables)
+			table.SetDensity(density);
+	}
+
+	const RangeTable* Target::GetRangeTable(int zp, int ap) const
+	{
+		auto iter = m_rangeTables.find(GetUUID(zp, ap));
+		if(iter == m_rangeTables.end())
+			return nullptr;
+		return &(iter->second);
+	}
+
+	//ZP, AP: projectile isotope, energy: MeV
+	//return range in m
+	double Target::GetRange(int zp, int ap, double energy) const
+	{
+		const RangeTable* table = GetRangeTable(zp, ap);
+		if(table != nullptr)
+			return table->GetRange(energy);
+		if(Precision::IsFloatLessOrAlmostEqual(energy, 0.0, s_epsilon))
+			return 0.0;
+		catima::Projectile proj(MassLookup::GetInstance().FindMassU(zp, ap), zp, 0.0, 0.0);
+		proj.T = energy/proj.A;
+		std::scoped_lock<std::mutex> guard(GetCatimaMutex());
+		return catima::range(proj, m_material) / m_material.density() * 0.01; //g/cm^2 -> m
+	}
+
+	/*
+		Transport a particle once along its track, recording the energy at each crossing. With a range table every crossing
+		is a lookup from the same starting range; otherwise catima integrates only the segment between consecutive crossings.
+	*/
+	//ZP, AP: projectile isotope, startEnergy: MeV, pathLengths: m (ascending), energies: MeV
+	void Target::GetEnergiesAlongPath(int zp, int ap, double startEnergy, const double* pathLengths, double* energies, std::size_t nPoints) const
+	{
+		const RangeTable* table = GetRangeTable(zp, ap);
+		if(table != nullptr)
+		{
+			double startRange = table->GetRange(startEnergy);
+			for(std::size_t i=0; i<nPoints; i++)
+				energies[i] = table->GetEnergy(startRange - pathLengths[i]);
+			return;
+		}
+
+		catima::Projectile proj(MassLookup::GetInstance().FindMassU(zp, ap), zp, 0.0, 0.0);
+		catima::Material material = m_material;
+		double energy = startEnergy;
+		double previousPath = 0.0;
+		std::scoped_lock<std::mutex> guard(GetCatimaMutex());
+		for(std::size_t i=0; i<nPoints; i++)
+		{
+			if(!Precision::IsFloatLessOrAlmostEqual(energy, 0.0, s_epsilon))
+			{
+				proj.T = energy/proj.A;
+				material.thickness_cm((pathLengths[i] - previousPath) * 100.0);
+				energy = catima::energy_out(proj, material) * proj.A;
+			}
+			else
+				energy = 0.0;
+			previousPath = pathLengths[i];
+			energies[i] = energy;
+		}
+	}
+
+	std::mutex& Target::GetCatimaMutex()
+	{
+		static std::mutex s_catimaMutex;
+		return s_catimaMutex;
+	}
+
 }
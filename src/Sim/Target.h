@@ -5,6 +5,8 @@ A basic target unit for use in the Mask environment. A target
 is defined as a single compound with elements Z,A of a given stoichiometry
 Holds an energy loss class
 
+Const methods do not modify the target and may be called from several threads at once.
+
 Based on code by D.W. Visser written at Yale for the original SPANC
 
 Written by G.W. McCann Aug. 2020
@@ -16,8 +18,12 @@ Written by G.W. McCann Aug. 2020
 #include <string>
 #include <vector>
 #include <cmath>
+#include <unordered_map>
+#include <mutex>
 #include "catima/gwm_integrators.h"
 #include "MassLookup.h"
+#include "RangeTable.h"
+#include "TableCache.h"
 
 namespace AnasenSim {
 
@@ -28,14 +34,27 @@ namespace AnasenSim {
 	 	Target(const std::vector<uint32_t>& z, const std::vector<uint32_t>& a, const std::vector<int>& stoich, double density);
 	 	~Target();
 
-	 	double GetEnergyLoss(int zp, int ap, double startEnergy, double pathLength);
+	 	double GetEnergyLoss(int zp, int ap, double startEnergy, double pathLength) const;
 	 	double GetReverseEnergyLoss(int zp, int ap, double finalEnergy, double pathLength);
-		double GetPathLength(int zp, int ap, double startEnergy, double finalEnergy); //Returns pathlength for a particle w/ startE to reach finalE (cm)
+		double GetPathLength(int zp, int ap, double startEnergy, double finalEnergy) const; //Returns pathlength for a particle w/ startE to reach finalE (cm)
 		double GetAngularStraggling(int zp, int ap, double energy, double pathLength); //Returns planar angular straggling in radians for a particle with energy and pathLength
-	 	inline double GetDensity() { return m_material.density(); } //g/cm^3
+	 	inline double GetDensity() const { return m_material.density(); } //g/cm^3
+		//Change the density in place; the range tables are density independent and are kept
+		void SetDensity(double density); //g/cm^3
+
+		//Range tables are built (or loaded from cache) once per projectile at init; lookups fall back to catima if no table exists
+		void InitRangeTable(int zp, int ap, const TableCache* cache = nullptr);
+		const RangeTable* GetRangeTable(int zp, int ap) const;
+		double GetRange(int zp, int ap, double energy) const; //Returns range in m for a particle with energy (MeV)
+		//Single transport along a straight track. Returns the energy (MeV) at each of nPoints ascending path lengths (m)
+		void GetEnergiesAlongPath(int zp, int ap, double startEnergy, const double* pathLengths, double* energies, std::size_t nPoints) const;
 	
 	private:
+		//catima caches energy loss data in global storage, so every catima call is serialized through this lock
+		static std::mutex& GetCatimaMutex();
+
 		catima::Material m_material;
+		std::unordered_map<uint32_t, RangeTable> m_rangeTables;
 
 		static constexpr double s_epsilon = 1.0e-6;
 	};
@@ -1,6 +1,7 @@
 #include "TwoStepSystem.h"
 #include "RandomGenerator.h"
 
+#include <limits>
 #include <sstream>
 
 namespace AnasenSim {
@@ -8,9 +9,6 @@ namespace AnasenSim {
 	TwoStepSystem::TwoStepSystem(const SystemParameters& params) :
 		ReactionSystem(params)
 	{
-		int zp = m_params.stepParams[0].Z[1];
-		int ap = m_params.stepParams[0].A[1];
-		
 		Init();
 	}
 	
@@ -43,20 +41,30 @@ namespace AnasenSim {
 		int zb = step2Params.Z[0] - step2Params.Z[1];
 		int ab = step2Params.A[0] - step2Params.A[1];
 
-		m_nuclei.resize(6);
 		m_nuclei[0] = CreateNucleus(step1Params.Z[0], step1Params.A[0], Nucleus::ReactionRole::Target); //target
 		m_nuclei[1] = CreateNucleus(step1Params.Z[1], step1Params.A[1], Nucleus::ReactionRole::Projectile); //projectile
 		m_nuclei[2] = CreateNucleus(step1Params.Z[2], step1Params.A[2], Nucleus::ReactionRole::Ejectile); //ejectile
 		m_nuclei[3] = CreateNucleus(zr, ar, Nucleus::ReactionRole::Residual); //residual
-		m_nuclei[4] = CreateNucleus(step2Params.Z[1], step2Params.A[1], Nucleus::ReactionRole::Breakup1); //breakup1
-		m_nuclei[5] = CreateNucleus(zb, ab, Nucleus::ReactionRole::Breakup2); //breakup2
+		m_nuclei[4] = CreateNucleus(step2Params.Z[1], step2Params.A[1], Nucleus::ReactionRole::Breakup1, 1); //breakup1
+		m_nuclei[5] = CreateNucleus(zb, ab, Nucleus::ReactionRole::Breakup2, 1); //breakup2
 
 		m_step1.BindNuclei(&(m_nuclei[0]), &(m_nuclei[1]), &(m_nuclei[2]), &(m_nuclei[3]));
 		m_step2.BindNuclei(&(m_nuclei[3]), nullptr, &(m_nuclei[4]), &(m_nuclei[5]));
 		SetSystemEquation();
+		//The residual must be able to decay to the lowest breakup2 excitation, and reach no higher than the beam allows
+		double maxBeamEnergy = m_params.sampleBeam ? m_params.initialBeamEnergy : m_params.rxnBeamEnergy;
+		double minResidEx = GetFullLineshape(step2Params).GetMinimum() - m_step2.GetMaxDecayExcitation(0.0);
+		if(!InitLineshape(m_residExLineshape, step1Params, minResidEx, m_step1.GetMaxReactionExcitation(maxBeamEnergy)))
+			return;
+		InitLineshape(m_decay2ExLineshape, step2Params, -std::numeric_limits<double>::infinity(), m_step2.GetMaxDecayExcitation(m_residExLineshape.GetMaximum()));
+		m_rxnDistribution = step1Params.angularDistribution;
+		m_decay1Distribution = step2Params.angularDistribution;
 
-		if(!m_params.sampleBeam)
+		if(m_params.sampleBeam)
+			InitBeamTables(m_nuclei[1]);
+		else
 		{
+			m_beamTheta = 0.0; //A fixed beam is not straggled, see SampleParameters
 			m_rxnBeamEnergy = m_params.rxnBeamEnergy;
 			m_rxnPathLength = m_params.target.GetPathLength(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_rxnBeamEnergy);
 			m_beamStraggling = m_params.target.GetAngularStraggling(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_rxnPathLength);
@@ -66,30 +74,30 @@ namespace AnasenSim {
 	void TwoStepSystem::SetSystemEquation()
 	{
 		std::stringstream stream;
-		stream << m_nuclei[0].isotopicSymbol << "("
-			   << m_nuclei[1].isotopicSymbol << ", "
-			   << m_nuclei[2].isotopicSymbol << ")"
-			   << m_nuclei[3].isotopicSymbol << "->"
-			   << m_nuclei[4].isotopicSymbol << "+"
-			   << m_nuclei[5].isotopicSymbol;
+		stream << GetIsotopicSymbol(m_nuclei[0]) << "("
+			   << GetIsotopicSymbol(m_nuclei[1]) << ", "
+			   << GetIsotopicSymbol(m_nuclei[2]) << ")"
+			   << GetIsotopicSymbol(m_nuclei[3]) << "->"
+			   << GetIsotopicSymbol(m_nuclei[4]) << "+"
+			   << GetIsotopicSymbol(m_nuclei[5]);
 		m_sysEquation = stream.str();
 	}
 
 	void TwoStepSystem::SampleParameters()
 	{
-		m_rxnTheta = std::acos(RandomGenerator::GetUniformReal(s_cosThetaMin, s_cosThetaMax));
+		m_rxnTheta = m_rxnDistribution.SampleTheta();
 		m_rxnPhi = RandomGenerator::GetUniformReal(s_phiMin, s_phiMax);
-		m_decay1Theta = std::acos(RandomGenerator::GetUniformReal(s_cosThetaMin, s_cosThetaMax));
+		m_decay1Theta = m_decay1Distribution.SampleTheta();
 		m_decay1Phi = RandomGenerator::GetUniformReal(s_phiMin, s_phiMax);
-		m_residEx = RandomGenerator::GetNormal(m_params.stepParams[0].meanResidualEx, m_params.stepParams[0].sigmaResidualEx);
-		m_decay2Ex = RandomGenerator::GetNormal(m_params.stepParams[1].meanResidualEx, m_params.stepParams[1].sigmaResidualEx);
+		m_residEx = m_residExLineshape.Sample();
+		m_decay2Ex = m_decay2ExLineshape.Sample();
 		//m_beamTheta = RandomGenerator::GetUniformReal(0.0, m_beamStraggling);
 		m_beamPhi = RandomGenerator::GetUniformReal(s_phiMin, s_phiMax);
 		if(m_params.sampleBeam)
 		{
 			m_rxnBeamEnergy = RandomGenerator::GetUniformReal(0.0, m_params.initialBeamEnergy);
 			m_rxnPathLength = m_params.target.GetPathLength(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_rxnBeamEnergy);
-			m_beamStraggling = m_params.target.GetAngularStraggling(m_nuclei[1].Z, m_nuclei[1].A, m_params.initialBeamEnergy, m_rxnPathLength);
+			m_beamStraggling = GetBeamStraggling(m_rxnPathLength);
 			m_beamTheta = RandomGenerator::GetUniformReal(0.0, m_beamStraggling);
 		}
 		//Testing against Nabin
@@ -99,7 +107,7 @@ namespace AnasenSim {
 	void TwoStepSystem::RunSystem()
 	{
 		
-		static ROOT::Math::XYZPoint rxnPoint;
+		ROOT::Math::XYZPoint rxnPoint;
 
 		SampleParameters();
 		//Check to make sure that the sampled configuration is valid (energy is conserved)
@@ -127,7 +135,7 @@ namespace AnasenSim {
 		m_step2.Calculate();
 
 		for(auto& nucleus : m_nuclei)
-			nucleus.rxnPoint = rxnPoint;
+			nucleus.SetRxnPoint(rxnPoint);
 	
 	}
 
@@ -5,19 +5,24 @@
 
 namespace AnasenSim {
 
-	class TwoStepSystem : public ReactionSystem
+	class TwoStepSystem final : public ReactionSystem
 	{
 	public:
+		static constexpr std::size_t s_nNuclei = 6;
+
 		TwoStepSystem(const SystemParameters& params);
 		~TwoStepSystem();
 
-		virtual void RunSystem() override;
+		void RunSystem();
+		const std::array<NucleusRecord, s_nNuclei>& GetNuclei() const { return m_nuclei; }
 	
 	private:
 		void Init();
-		void SetSystemEquation() override;
+		void SetSystemEquation();
 		void SampleParameters();
 
+		std::array<NucleusRecord, s_nNuclei> m_nuclei;
+
 		//reaction parameters
 		double m_rxnPathLength;
 		double m_beamStraggling;
@@ -28,6 +33,10 @@ namespace AnasenSim {
 		double m_decay1Phi;
 		double m_residEx;
 		double m_decay2Ex;
+		Lineshape m_residExLineshape;
+		Lineshape m_decay2ExLineshape;
+		AngularDistribution m_rxnDistribution;
+		AngularDistribution m_decay1Distribution;
 		double m_beamTheta;
 		double m_beamPhi;
 
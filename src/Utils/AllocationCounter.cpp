@@ -0,0 +1,93 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace AnasenSim {
+
+	static std::atomic<uint64_t> s_allocationCount{0};
+	static std::atomic<uint64_t> s_allocationBytes{0};
+
+	bool IsAllocationCountingEnabled()
+	{
+#ifdef ASIM_COUNT_ALLOCATIONS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	AllocationCount GetAllocationCount()
+	{
+		AllocationCount result;
+		result.count = s_allocationCount.load(std::memory_order_relaxed);
+		result.bytes = s_allocationBytes.load(std::memory_order_relaxed);
+		return result;
+	}
+
+#ifdef ASIM_COUNT_ALLOCATIONS
+	static void* CountedAllocate(std::size_t size, std::size_t alignment)
+	{
+		s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+		s_allocationBytes.fetch_add(size, std::memory_order_relaxed);
+		if(size == 0)
+			size = 1;
+		if(alignment <= alignof(std::max_align_t))
+			return std::malloc(size);
+		return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment); //size must be a multiple of alignment
+	}
+#endif
+
+}
+
+#ifdef ASIM_COUNT_ALLOCATIONS
+//Replacements for every global allocation function. Everything is released with free, so all deletes share one body.
+void* operator new(std::size_t size)
+{
+	void* pointer = AnasenSim::CountedAllocate(size, 0);
+	if(pointer == nullptr)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	void* pointer = AnasenSim::CountedAllocate(size, std::size_t(alignment));
+	if(pointer == nullptr)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return AnasenSim::CountedAllocate(size, 0);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return AnasenSim::CountedAllocate(size, 0);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+#endif
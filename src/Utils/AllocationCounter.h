@@ -0,0 +1,25 @@
+/*
+	AllocationCounter.h
+	Opt-in heap allocation counting. Built with ASIM_COUNT_ALLOCATIONS (CMake option of the same name), the global operator
+	new/delete are replaced by versions that count every allocation process-wide; otherwise the counts stay at zero.
+*/
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace AnasenSim {
+
+	struct AllocationCount
+	{
+		uint64_t count = 0;
+		uint64_t bytes = 0;
+	};
+
+	bool IsAllocationCountingEnabled();
+	//Allocations made since program start, by all threads
+	AllocationCount GetAllocationCount();
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#include "ChildProcess.h"
+
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace AnasenSim {
+
+	int RunSelf(const std::vector<std::string>& args)
+	{
+		//Built before the fork: the child only calls exec, which is safe even when the parent has other threads running
+		std::vector<std::string> argStrings = {"AnasenSim"};
+		argStrings.insert(argStrings.end(), args.begin(), args.end());
+		std::vector<char*> argv;
+		for(std::string& arg : argStrings)
+			argv.push_back(arg.data());
+		argv.push_back(nullptr);
+
+		std::cout << std::flush;
+		pid_t pid = fork();
+		if(pid < 0)
+		{
+			std::cerr << "Unable to start a child process at RunSelf!" << std::endl;
+			return -1;
+		}
+		else if(pid == 0)
+		{
+			execv("/proc/self/exe", argv.data());
+			_exit(127);
+		}
+
+		int status = 0;
+		if(waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+			return -1;
+		return WEXITSTATUS(status);
+	}
+
+}
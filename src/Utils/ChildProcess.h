@@ -0,0 +1,15 @@
+#ifndef CHILD_PROCESS_H
+#define CHILD_PROCESS_H
+
+#include <string>
+#include <vector>
+
+namespace AnasenSim {
+
+	//Run this binary again (Linux /proc/self/exe) with the given arguments, in a fresh process, and wait for it.
+	//Returns its exit status, or -1 if it could not be started or did not exit normally
+	int RunSelf(const std::vector<std::string>& args);
+
+}
+
+#endif
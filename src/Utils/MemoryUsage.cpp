@@ -0,0 +1,41 @@
+#include "MemoryUsage.h"
+
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+
+namespace AnasenSim {
+
+	//Linux reports the (resettable) high water mark as VmHWM in /proc/self/status; otherwise fall back to getrusage
+	uint64_t GetPeakRSS()
+	{
+		std::ifstream status("/proc/self/status");
+		std::string key;
+		uint64_t value;
+		while(status >> key)
+		{
+			if(key == "VmHWM:" && status >> value)
+				return value * 1024; //kB
+			std::getline(status, key);
+		}
+
+		struct rusage usage;
+		if(getrusage(RUSAGE_SELF, &usage) != 0)
+			return 0;
+#ifdef __APPLE__
+		return uint64_t(usage.ru_maxrss); //bytes
+#else
+		return uint64_t(usage.ru_maxrss) * 1024; //kB
+#endif
+	}
+
+	bool ResetPeakRSS()
+	{
+		std::ofstream clearRefs("/proc/self/clear_refs");
+		if(!clearRefs.is_open())
+			return false;
+		clearRefs << "5";
+		return bool(clearRefs);
+	}
+
+}
@@ -0,0 +1,15 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <cstdint>
+
+namespace AnasenSim {
+
+	//Peak resident set size of the process in bytes, or 0 if it cannot be determined
+	uint64_t GetPeakRSS();
+	//Restart peak RSS tracking from the current RSS (Linux only), so GetPeakRSS covers only what follows. Returns false if unsupported
+	bool ResetPeakRSS();
+
+}
+
+#endif
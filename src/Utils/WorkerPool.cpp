@@ -0,0 +1,83 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+namespace AnasenSim {
+
+	WorkerPool::WorkerPool() {}
+
+	WorkerPool::~WorkerPool()
+	{
+		Stop();
+	}
+
+	void WorkerPool::Start(std::size_t nWorkers)
+	{
+		Stop();
+		m_nWorkers = std::max<std::size_t>(nWorkers, 1);
+		if(m_nWorkers == 1)
+			return;
+
+		m_isStopping = false;
+		for(std::size_t worker=0; worker<m_nWorkers; worker++)
+			m_threads.emplace_back(&WorkerPool::WorkerLoop, this, worker);
+	}
+
+	void WorkerPool::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isStopping = true;
+		}
+		m_jobCondition.notify_all();
+		for(std::thread& thread : m_threads)
+			thread.join();
+		m_threads.clear();
+		m_nWorkers = 1;
+		m_jobID = 0; //Threads started later begin waiting for job 1
+	}
+
+	void WorkerPool::Run(std::size_t nRecords, const Work& work)
+	{
+		if(m_threads.empty())
+		{
+			work(0, 0, nRecords);
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_work = &work;
+		m_nRecords = nRecords;
+		m_nBusy = m_threads.size();
+		m_jobID++;
+		m_jobCondition.notify_all();
+		m_doneCondition.wait(lock, [this]() { return m_nBusy == 0; });
+		m_work = nullptr;
+	}
+
+	void WorkerPool::WorkerLoop(std::size_t worker)
+	{
+		uint64_t lastJob = 0;
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while(true)
+		{
+			m_jobCondition.wait(lock, [this, lastJob]() { return m_isStopping || m_jobID != lastJob; });
+			if(m_isStopping)
+				return;
+			lastJob = m_jobID;
+
+			const Work& work = *m_work;
+			std::size_t perWorker = (m_nRecords + m_nWorkers - 1) / m_nWorkers;
+			std::size_t begin = std::min(worker * perWorker, m_nRecords);
+			std::size_t end = std::min(begin + perWorker, m_nRecords);
+			lock.unlock();
+			if(begin < end)
+				work(worker, begin, end);
+			lock.lock();
+
+			if(--m_nBusy == 0)
+				m_doneCondition.notify_one();
+		}
+	}
+
+}
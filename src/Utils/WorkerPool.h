@@ -0,0 +1,49 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AnasenSim {
+
+	//Fixed set of worker threads, started once and handed one job at a time. A job splits records [0, nRecords) into
+	//contiguous ranges, one per worker, and calls work(worker, begin, end) on each
+	class WorkerPool
+	{
+	public:
+		using Work = std::function<void(std::size_t, std::size_t, std::size_t)>;
+
+		WorkerPool();
+		~WorkerPool();
+
+		//Start nWorkers threads, stopping any already running. With one worker (or none) jobs run on the calling thread
+		void Start(std::size_t nWorkers);
+		void Stop();
+		//Returns once every worker has finished its range
+		void Run(std::size_t nRecords, const Work& work);
+
+		std::size_t GetNumberOfWorkers() const { return m_nWorkers; }
+
+	private:
+		void WorkerLoop(std::size_t worker);
+
+		std::size_t m_nWorkers = 1;
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_jobCondition;
+		std::condition_variable m_doneCondition;
+		const Work* m_work = nullptr; //Job in progress, owned by the caller of Run
+		std::size_t m_nRecords = 0;
+		uint64_t m_jobID = 0; //Incremented for every job, so a worker runs each one exactly once
+		std::size_t m_nBusy = 0;
+		bool m_isStopping = false;
+	};
+
+}
+
+#endif
@@ -1,12 +1,36 @@
 #include "Sim/Application.h"
+#include "Sim/Benchmark.h"
 #include "Detectors/AnasenArray.h"
 #include "Utils/Timer.h"
 
 #include <iostream>
+#include <string>
 
 int main(int argc, char** argv)
 {
-    if(argc != 2)
+    //AnasenSim --benchmark-single <name> <input_file> <results_file> runs one benchmark; --benchmark starts one per configuration
+    if(argc == 5 && std::string(argv[1]) == "--benchmark-single")
+        return AnasenSim::Benchmark::RunSingle(argv[2], argv[3], argv[4]) ? 0 : 1;
+
+    //AnasenSim --benchmark <benchmark_file> <results_file> [baseline_file] runs the reference configurations and flags regressions
+    if(argc >= 4 && argc <= 5 && std::string(argv[1]) == "--benchmark")
+    {
+        AnasenSim::Benchmark benchmark(argv[2]);
+        bool isPassed = benchmark.Run(argv[3], argc == 5 ? argv[4] : "");
+        return isPassed ? 0 : 1;
+    }
+
+    //AnasenSim --validate <input_file> <validation_file> checks the fast detector paths against the reference ones
+    bool isValidation = argc == 4 && std::string(argv[1]) == "--validate";
+    //AnasenSim --check-allocations <input_file> fails if the steady-state event loop allocates (needs ASIM_COUNT_ALLOCATIONS)
+    bool isAllocationCheck = argc == 3 && std::string(argv[1]) == "--check-allocations";
+    //AnasenSim --resume <input_file> continues an interrupted run from the last checkpoint in its output file
+    bool isResume = argc == 3 && std::string(argv[1]) == "--resume";
+    //AnasenSim --check-resume <input_file> fails if a run interrupted part way and resumed differs from an uninterrupted one
+    bool isResumeCheck = argc == 3 && std::string(argv[1]) == "--check-resume";
+    //AnasenSim --check-resume-interrupt <input_file> <output_file> is the interrupted run, started by --check-resume
+    bool isInterrupted = argc == 4 && std::string(argv[1]) == "--check-resume-interrupt";
+    if(argc != 2 && !isValidation && !isAllocationCheck && !isResume && !isResumeCheck && !isInterrupted)
     {
         std::cerr << "Err! AnasenSim needs a configuration file to run!" << std::endl;
         return 1;
@@ -16,7 +40,7 @@ int main(int argc, char** argv)
     //array.DrawDetectorSystem("etc/array.txt");
 
     
-    AnasenSim::Application* myApp = new AnasenSim::Application(argv[1]);
+    AnasenSim::Application* myApp = new AnasenSim::Application(argc > 2 ? argv[2] : argv[1]);
 
     if(!myApp->IsInit())
     {
@@ -25,13 +49,38 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if(isValidation)
+    {
+        bool isPassed = myApp->RunValidation(argv[3]);
+        delete myApp;
+        return isPassed ? 0 : 1;
+    }
+    else if(isAllocationCheck)
+    {
+        bool isPassed = myApp->RunAllocationCheck();
+        delete myApp;
+        return isPassed ? 0 : 1;
+    }
+    else if(isResumeCheck)
+    {
+        bool isPassed = myApp->RunResumeCheck(argv[2]);
+        delete myApp;
+        return isPassed ? 0 : 1;
+    }
+    else if(isInterrupted)
+    {
+        myApp->RunInterrupted(argv[3]);
+        delete myApp;
+        return 1;
+    }
+
     AnasenSim::Timer watch;
     watch.Start();
-    myApp->Run();
+    bool isDone = isResume ? myApp->Resume() : myApp->Run();
     watch.Stop();
 
     std::cout << "Elapsed time: " << watch.GetElapsedMilliseconds() << " ms" << std::endl;
 
     delete myApp;
-    
+    return isDone ? 0 : 1;
 }
\ No newline at end of file